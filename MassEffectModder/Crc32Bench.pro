@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+
+CONFIG += ordered
+
+!win32 {
+SUBDIRS += Libs/omp
+}
+
+SUBDIRS += \
+    Crc32Bench
@@ -0,0 +1,40 @@
+QT -= gui core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG += sdk_no_version_check
+
+TARGET = Crc32Bench
+
+TEMPLATE = app
+
+SOURCES += \
+    ../MassEffectModder/Helpers/Crc32.cpp \
+    Main.cpp
+
+HEADERS += \
+    ../MassEffectModder/Helpers/Crc32.h
+
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+QMAKE_CXXFLAGS_DEBUG += -g
+
+INCLUDEPATH += $$PWD/../MassEffectModder
+!win32 {
+    INCLUDEPATH += $$PWD/../Libs/omp
+}
+
+macx {
+    QMAKE_CXXFLAGS += -Xpreprocessor -fopenmp
+    LIBS += -L$$OUT_PWD/../Libs/omp -lomp
+}
+
+win32 {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -lgomp
+}
+
+linux {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -L$$OUT_PWD/../Libs/omp -lomp -ldl -lpthread
+}
@@ -0,0 +1,123 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <Helpers/Crc32.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+typedef uint32_t (*CrcFunc)(const void *data, size_t length, uint32_t previousCrc32);
+
+static uint32_t Crc16BytesPrefetch(const void *data, size_t length, uint32_t previousCrc32)
+{
+    return crc32_16bytes_prefetch(data, length, previousCrc32);
+}
+
+struct CrcBench
+{
+    const char *name;
+    CrcFunc func;
+};
+
+static double RunBench(CrcFunc func, const std::vector<uint8_t> &data, size_t blockSize,
+                       int iterations, uint32_t &crc)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (size_t offset = 0; offset < data.size(); offset += blockSize)
+        {
+            size_t len = blockSize;
+            if (offset + len > data.size())
+                len = data.size() - offset;
+            crc = func(data.data() + offset, len, crc);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (double)data.size() * iterations / (1024.0 * 1024.0) / seconds;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t totalSize = 256 * 1024 * 1024;
+    int iterations = 4;
+    if (argc > 1)
+        totalSize = strtoull(argv[1], nullptr, 10) * 1024 * 1024;
+    if (argc > 2)
+        iterations = atoi(argv[2]);
+    if (totalSize == 0 || iterations <= 0)
+    {
+        fprintf(stderr, "Usage: Crc32Bench [size in MB] [iterations]\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> data(totalSize);
+    uint32_t seed = 0x12345678;
+    for (auto &byte : data)
+    {
+        seed = seed * 1664525 + 1013904223;
+        byte = (uint8_t)(seed >> 24);
+    }
+
+    const CrcBench benches[] =
+    {
+        { "16bytes",          crc32_16bytes },
+        { "16bytes_prefetch", Crc16BytesPrefetch },
+        { "pclmul",           crc32_pclmul },
+        { "hw",               crc32_hw },
+        { "parallel",         crc32_parallel },
+    };
+    // typical sizes: small mips, top mip of 1K DXT1, top mip of 4K DXT5, whole buffer
+    const size_t blockSizes[] = { 4 * 1024, 512 * 1024, 16 * 1024 * 1024, totalSize };
+
+    uint32_t reference = crc32_16bytes(data.data(), data.size());
+    bool mismatch = false;
+
+    printf("{\n  \"pclmul_supported\": %s,\n  \"size_mb\": %zu,\n  \"iterations\": %d,\n  \"results\": [\n",
+           crc32_pclmul_supported() ? "true" : "false", totalSize / (1024 * 1024), iterations);
+    bool first = true;
+    for (const auto &bench : benches)
+    {
+        if (bench.func == crc32_pclmul && !crc32_pclmul_supported())
+            continue;
+        if (bench.func(data.data(), data.size(), 0) != reference)
+        {
+            fprintf(stderr, "CRC mismatch: %s\n", bench.name);
+            mismatch = true;
+            continue;
+        }
+        for (size_t blockSize : blockSizes)
+        {
+            uint32_t crc = 0;
+            double speed = RunBench(bench.func, data, blockSize, iterations, crc);
+            printf("%s    { \"name\": \"%s\", \"block_size\": %zu, \"mb_per_s\": %.1f, \"crc\": \"0x%08X\" }",
+                   first ? "" : ",\n", bench.name, blockSize, speed, crc);
+            first = false;
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    return mismatch ? 1 : 0;
+}
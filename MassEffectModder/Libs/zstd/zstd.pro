@@ -3,28 +3,35 @@ CONFIG += staticlib
 
 QT -= gui core
 
+# decompression is always built, it's needed to read MEM mods with zstd entries
 SOURCES += \
            debug.c \
            entropy_common.c \
            error_private.c \
-           fse_compress.c \
            fse_decompress.c \
-           hist.c \
-           huf_compress.c \
            huf_decompress.c \
-           pool.c \
-           threading.c \
            hash.c \
            zstd_common.c \
-           zstd_compress.c \
            zstd_ddict.c \
            zstd_decompress.c \
-           zstd_decompress_block.c \
+           zstd_decompress_block.c
+
+equals(ZSTD_ENABLE, true) {
+SOURCES += \
+           fse_compress.c \
+           hist.c \
+           huf_compress.c \
+           pool.c \
+           threading.c \
+           zstd_compress.c \
+           zstd_compress_literals.c \
+           zstd_compress_sequences.c \
            zstd_double_fast.c \
            zstd_fast.c \
            zstd_lazy.c \
            zstd_ldm.c \
            zstd_opt.c
+}
 
 HEADERS += \
            bitstream.h \
@@ -40,6 +47,8 @@ HEADERS += \
            threading.h \
            xxhash.h \
            zstd_compress_internal.h \
+           zstd_compress_literals.h \
+           zstd_compress_sequences.h \
            zstd_ddict.h \
            zstd_decompress_block.h \
            zstd_decompress_internal.h \
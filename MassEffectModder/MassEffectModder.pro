@@ -1,7 +1,10 @@
 include(MassEffectModderCommon.pri)
 
-ZSTD_ENABLE = false
+ZSTD_ENABLE = true
 cache(ZSTD_ENABLE, set)
 
+TRACE_ENABLE = true
+cache(TRACE_ENABLE, set)
+
 GUI_MODE = true
 cache(GUI_MODE, set)
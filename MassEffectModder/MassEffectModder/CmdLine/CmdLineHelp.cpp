@@ -76,7 +76,8 @@ void DisplayHelp()
         "  --print-lods --gameid <game id> [--ipc]\n" \
         "     Print LODs settings.\n" \
         "\n" \
-        "  --convert-to-mem --gameid <game id> --input <input dir> --output <output file> [--mark-to-convert] [--ipc]\n" \
+        "  --convert-to-mem --gameid <game id> --input <input dir> --output <output file> [--mark-to-convert]\n" \
+        "  [--memory-budget <MB>] [--zstd] [--ipc]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     input dir: directory to be converted, containing following file extension(s):\n" \
         "        MEM, MOD, TPF\n" \
@@ -104,6 +105,11 @@ void DisplayHelp()
         "           Image filename must include texture CRC (0xhhhhhhhh)\n" \
         "        BIK\n" \
         "           Movie filename must include texture CRC (0xhhhhhhhh)\n" \
+        "     memory budget: amount of input data in MB processed in parallel,\n" \
+        "        default is quarter of system memory, but not less than 1024\n" \
+        "     zstd: compress entries with zstd, faster to install,\n" \
+        "        but not readable by MEM versions without zstd support\n" \
+        "        available only in builds with zstd compression enabled\n" \
         "     ipc: turn on IPC traces\n" \
         "\n" \
         "  --convert-game-image --gameid <game id> --input <input image> --output <output image> [--mark-to-convert]\n" \
@@ -132,6 +138,8 @@ void DisplayHelp()
         "              uncompressed ARGB/RGB/RGBX\n" \
         "           Image filename must include texture CRC (0xhhhhhhhh)\n" \
         "     output dir: directory where textures converted to DDS are placed\n" \
+        "     Images are converted in parallel, outputs with unchanged source are skipped\n" \
+        "     by hash stored in <output>.srchash file.\n" \
         "\n" \
         "  --extract-mod --gameid <game id> --input <input dir/file> [--output <output dir>] [--ipc]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
@@ -175,6 +183,7 @@ void DisplayHelp()
         "     For DXT1a you have to set the alpha threshold (0-255). 128 is suggested as a default value.\n" \
         "\n" \
         "  --extract-all-dds --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc]\n" \
+        "  [--filter <string>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     output dir: directory where textures converted to DDS are placed\n" \
         "     TFC filter name: it will filter only textures stored in specific TFC file.\n" \
@@ -182,9 +191,11 @@ void DisplayHelp()
         "     Or option: --tfc-only to extract only textures stored in TFC files.\n" \
         "     Package path: single package mode.\n" \
         "     Map Crc: it will try to find vanilla texture crc from texture map.\n" \
+        "     If filter param is provided, extract only from packages matched by filter \"string\".\n" \
         "     Textures are extracted as they are in game data, only DDS header is added.\n" \
         "\n" \
         "  --extract-all-png --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc]\n" \
+        "  [--filter <string>] [--png-level <level>] [--png-filter <filter>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     output dir: directory where textures converted to PNG are placed\n" \
         "     TFC filter name: it will filter only textures stored in specific TFC file.\n" \
@@ -192,7 +203,10 @@ void DisplayHelp()
         "     Or option: --tfc-only to extract only textures stored in TFC files.\n" \
         "     Package path: single package mode.\n" \
         "     Map Crc: it will try to find vanilla texture crc from texture map.\n" \
+        "     If filter param is provided, extract only from packages matched by filter \"string\".\n" \
         "     Textures are extracted with only top mipmap.\n" \
+        "     PNG level: zlib compression level 0-9, default is 6.\n" \
+        "     PNG filter: row filter: adaptive (default), none, sub, up, average or paeth.\n" \
         "  --extract-all-bik --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     output dir: directory where movie textures are placed\n" \
@@ -230,6 +244,25 @@ void DisplayHelp()
         "\n" \
         "\n" \
         "  Additonal option to enable debug logs level to all commands: --debug-logs\n" \
+        "  Additonal option to ignore stored file hashes to all commands: --no-hash-cache\n" \
+        "     MD5 of game files is cached between runs in MEM config directory,\n" \
+        "     with this option all files are hashed again and the cache is refreshed\n" \
+        "  Additonal option to limit game files read bandwidth to all commands: --io-bandwidth <MB/s>\n" \
+        "     Number of parallel readers is chosen from storage type of game directory,\n" \
+        "     this option additionally caps read rate of game packages\n" \
+        "  Additonal option to limit number of worker threads to all commands: --threads <number>\n" \
+        "     By default all CPU cores are used, parallel loops nested in already\n" \
+        "     parallel work run on the calling thread\n" \
+        "  Additonal option to limit worker threads of one stage to all commands: --stage-threads <stage>=<number>\n" \
+        "     Can be given several times, stages: package-decompress, package-compress,\n" \
+        "     mod-data-compress, mod-data-decompress, mipmap-compress, mipmap-decompress,\n" \
+        "     dlc-extract\n" \
+        "  Additonal option to write performance trace to all commands: --trace-file <output file>\n" \
+        "     Trace is written in Chrome trace event JSON format,\n" \
+        "     available only in builds with tracing enabled\n" \
+        "\n" \
+        "  Summary of performance metrics is printed after every command,\n" \
+        "  with --ipc option it is emitted as [IPC]METRICS <json> line.\n" \
         "\n";
     PINFO(help);
 }
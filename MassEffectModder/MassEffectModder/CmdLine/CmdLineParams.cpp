@@ -21,14 +21,20 @@
 
 #include <CmdLine/CmdLineParams.h>
 #include <CmdLine/CmdLineTools.h>
+#include <Helpers/FileHashCache.h>
+#include <Helpers/IoPolicy.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/TaskScheduler.h>
+#include <Helpers/Trace.h>
 #include <GameData/DLC.h>
 #include <GameData/GameData.h>
 #include <GameData/TOCFile.h>
 #include <Misc/Misc.h>
 #include <Program/ConfigIni.h>
 #include <Types/MemTypes.h>
+#include <Wrappers.h>
 
 static bool hasValue(const QStringList &args, int curPos)
 {
@@ -41,6 +47,7 @@ int ProcessArguments()
     int cmd = CmdType::UNKNOWN;
     MeType gameId = MeType::UNKNOWN_TYPE;
     bool markToConvert = false;
+    bool useZstd = false;
     bool alotMode = false;
     bool repackMode = false;
     bool meuitmMode = false;
@@ -55,8 +62,11 @@ int ProcessArguments()
     bool compressed = true;
     int thresholdValue = 128;
     int cacheAmountValue = -1;
+    int memoryBudgetValue = 0;
+    int pngLevelValue = -1;
+    int pngFilterValue = PNG_WRITE_FILTER_ADAPTIVE;
     QString input, output, threshold, format, tfcName;
-    QString dlcName, path, cacheAmount, filter;
+    QString dlcName, path, cacheAmount, filter, traceFile;
     CmdLineTools tools;
 
     QStringList args = QCoreApplication::arguments();
@@ -195,6 +205,15 @@ int ProcessArguments()
             markToConvert = true;
             args.removeAt(l--);
         }
+        else if (arg == "--zstd")
+        {
+#if !defined(ZSTD_ENABLE)
+            PERROR("Zstd compression is not supported by this build!\n");
+            return -1;
+#endif
+            useZstd = true;
+            args.removeAt(l--);
+        }
         else if (arg == "--alot-mode")
         {
             alotMode = true;
@@ -299,6 +318,64 @@ int ProcessArguments()
             g_logs->ChangeLogLevel(LOG_DEBUG);
             args.removeAt(l--);
         }
+        else if (arg == "--no-hash-cache")
+        {
+            FileHashCache::SetIgnoreStored(true);
+            args.removeAt(l--);
+        }
+        else if (arg == "--io-bandwidth" && hasValue(args, l))
+        {
+            int bandwidth = args[l + 1].toInt();
+            if (bandwidth <= 0)
+            {
+                PERROR("Bandwidth limit must be positive value\n");
+                return -1;
+            }
+            IoPolicy::SetBandwidthLimit(static_cast<qint64>(bandwidth) * 1024 * 1024);
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--threads" && hasValue(args, l))
+        {
+            int threads = args[l + 1].toInt();
+            if (threads <= 0)
+            {
+                PERROR("Number of threads must be positive value\n");
+                return -1;
+            }
+            TaskScheduler::SetThreads(threads);
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--stage-threads" && hasValue(args, l))
+        {
+            QStringList cap = args[l + 1].split('=');
+            TaskScheduler::Stage stage;
+            if (cap.count() != 2 || !TaskScheduler::StageFromName(cap[0], stage))
+            {
+                PERROR("Wrong stage threads value: " + args[l + 1] + "\n");
+                return -1;
+            }
+            int threads = cap[1].toInt();
+            if (threads <= 0)
+            {
+                PERROR("Number of stage threads must be positive value\n");
+                return -1;
+            }
+            TaskScheduler::SetStageCap(stage, threads);
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--trace-file" && hasValue(args, l))
+        {
+#if !defined(TRACE_ENABLE)
+            PERROR("Tracing is not supported by this build!\n");
+            return -1;
+#endif
+            traceFile = args[l + 1].replace('\\', '/');
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
         else if (arg == "--path" && hasValue(args, l))
         {
             path = args[l + 1];
@@ -315,6 +392,41 @@ int ProcessArguments()
             args.removeAt(l);
             args.removeAt(l--);
         }
+        else if (arg == "--memory-budget" && hasValue(args, l))
+        {
+            memoryBudgetValue = args[l + 1].toInt();
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--png-level" && hasValue(args, l))
+        {
+            bool ok;
+            pngLevelValue = args[l + 1].toInt(&ok);
+            if (!ok)
+                pngLevelValue = -2;
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--png-filter" && hasValue(args, l))
+        {
+            const QString pngFilter = args[l + 1].toLower();
+            if (pngFilter == "adaptive")
+                pngFilterValue = PNG_WRITE_FILTER_ADAPTIVE;
+            else if (pngFilter == "none")
+                pngFilterValue = PNG_WRITE_FILTER_NONE;
+            else if (pngFilter == "sub")
+                pngFilterValue = PNG_WRITE_FILTER_SUB;
+            else if (pngFilter == "up")
+                pngFilterValue = PNG_WRITE_FILTER_UP;
+            else if (pngFilter == "average")
+                pngFilterValue = PNG_WRITE_FILTER_AVERAGE;
+            else if (pngFilter == "paeth")
+                pngFilterValue = PNG_WRITE_FILTER_PAETH;
+            else
+                pngFilterValue = -2;
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
         else if (arg == "--filter" && hasValue(args, l))
         {
             filter = args[l + 1];
@@ -350,6 +462,12 @@ int ProcessArguments()
         return 1;
     }
 
+    if (traceFile.length() != 0 && !Trace::Start(traceFile))
+    {
+        PERROR("Failed to create trace file: " + traceFile + "\n");
+        return 1;
+    }
+
     switch (cmd)
     {
     case CmdType::SCAN:
@@ -410,7 +528,13 @@ int ProcessArguments()
             errorCode = 1;
             break;
         }
-        if (!tools.ConvertToMEM(gameId, input, output, markToConvert))
+        if (memoryBudgetValue < 0)
+        {
+            PERROR("Memory budget must be positive value\n");
+            errorCode = 1;
+            break;
+        }
+        if (!tools.ConvertToMEM(gameId, input, output, markToConvert, memoryBudgetValue, useZstd))
             errorCode = 1;
         break;
     case CmdType::CONVERT_GAME_IMAGE:
@@ -689,7 +813,7 @@ int ProcessArguments()
             errorCode = 1;
             break;
         }
-        if (!tools.extractAllTextures(gameId, output, input, false, pccOnly, tfcOnly, mapCRC, tfcName))
+        if (!tools.extractAllTextures(gameId, output, input, false, pccOnly, tfcOnly, mapCRC, tfcName, filter))
             errorCode = 1;
         break;
     case CmdType::EXTRACT_ALL_PNG:
@@ -711,7 +835,20 @@ int ProcessArguments()
             errorCode = 1;
             break;
         }
-        if (!tools.extractAllTextures(gameId, output, input, true, pccOnly, tfcOnly, mapCRC, tfcName))
+        if (pngLevelValue < -1 || pngLevelValue > 9)
+        {
+            PERROR("PNG compression level must be in range 0-9\n");
+            errorCode = 1;
+            break;
+        }
+        if (pngFilterValue < PNG_WRITE_FILTER_ADAPTIVE)
+        {
+            PERROR("Wrong PNG filter, use: adaptive, none, sub, up, average or paeth\n");
+            errorCode = 1;
+            break;
+        }
+        if (!tools.extractAllTextures(gameId, output, input, true, pccOnly, tfcOnly, mapCRC, tfcName, filter,
+                                      pngLevelValue, pngFilterValue))
             errorCode = 1;
         break;
     case CmdType::EXTRACT_ALL_BIK:
@@ -812,5 +949,13 @@ int ProcessArguments()
         break;
     }
 
+    Metrics::PrintSummary();
+
+    if (traceFile.length() != 0)
+    {
+        Trace::Stop();
+        PINFO("Trace written to: " + traceFile + "\n");
+    }
+
     return errorCode;
 }
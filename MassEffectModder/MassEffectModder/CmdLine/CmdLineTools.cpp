@@ -24,6 +24,7 @@
 #include <GameData/DLC.h>
 #include <GameData/LODSettings.h>
 #include <GameData/TOCFile.h>
+#include <Helpers/FileStreamPool.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
 #include <Misc/Misc.h>
@@ -33,9 +34,14 @@
 #include <Wrappers.h>
 #include <Texture/Texture.h>
 #include <Texture/TextureMovie.h>
+#include <Texture/TextureMapFile.h>
 #include <Texture/TextureScan.h>
 #include <Types/MemTypes.h>
 
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+
 int CmdLineTools::scanTextures(MeType gameId, bool removeEmptyMips)
 {
     int errorCode;
@@ -128,7 +134,8 @@ bool CmdLineTools::unpackArchive(const QString &inputFile, QString &outputDir)
     return false;
 }
 
-bool CmdLineTools::ConvertToMEM(MeType gameId, QString &inputDir, QString &memFile, bool markToConvert)
+bool CmdLineTools::ConvertToMEM(MeType gameId, QString &inputDir, QString &memFile, bool markToConvert,
+                                int memoryBudgetMB, bool useZstd)
 {
     QList<TextureMapEntry> textures;
     Resources resources;
@@ -150,7 +157,8 @@ bool CmdLineTools::ConvertToMEM(MeType gameId, QString &inputDir, QString &memFi
     std::sort(list2.begin(), list2.end(), Misc::compareFileInfoPath);
     list.append(list2);
 
-    return Misc::convertDataModtoMem(list, memFile, gameId, textures, markToConvert, nullptr, nullptr);
+    return Misc::convertDataModtoMem(list, memFile, gameId, textures, markToConvert, nullptr, nullptr,
+                                    memoryBudgetMB, useZstd);
 }
 
 bool CmdLineTools::convertGameTexture(MeType gameId, const QString &inputFile,
@@ -191,12 +199,21 @@ bool CmdLineTools::convertGameTexture(MeType gameId, const QString &inputFile,
         }
     }
     image.correctMips(newPixelFormat, dxt1HasAlpha, dxt1Threshold);
-    if (QFile(outputFile).exists())
-        QFile(outputFile).remove();
-    FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
+    // Interrupted conversion must not leave truncated DDS in place of the old one
+    QSaveFile file(outputFile);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        PERROR(QString("Failed to write file: ") + outputFile + "\n");
+        return false;
+    }
     ByteBuffer buffer = image.StoreImageToDDS();
-    fs.WriteFromBuffer(buffer);
+    file.write(reinterpret_cast<const char *>(buffer.ptr()), buffer.size());
     buffer.Free();
+    if (!file.commit())
+    {
+        PERROR(QString("Failed to write file: ") + outputFile + "\n");
+        return false;
+    }
 
     return true;
 }
@@ -211,6 +228,62 @@ bool CmdLineTools::convertGameImage(MeType gameId, QString &inputFile, QString &
     return convertGameTexture(gameId, inputFile, outputFile, textures, markToConvert);
 }
 
+// Images from this size are converted one by one, letting the block
+// compressor use all cores, smaller ones are converted in parallel.
+#define CONVERT_LARGE_IMAGE_PIXELS (2048 * 2048)
+
+struct ConvertImageJob
+{
+    QString inputFile;
+    QString outputFile;
+    QString sourceHash;
+    qint64 pixels;
+    bool large;
+    bool converted;
+    bool skipped;
+    bool failed;
+};
+
+// Sidecar next to the output keeps hash of the source and settings it was converted with.
+static QString ConvertSidecarPath(const QString &outputFile)
+{
+    return outputFile + ".srchash";
+}
+
+static QString ConvertSourceHash(const QString &inputFile, MeType gameId, bool markToConvert)
+{
+    return QString(Misc::calculateMD5(inputFile).toHex()) +
+            QString(" %1 %2").arg((int)gameId).arg(markToConvert ? 1 : 0);
+}
+
+static bool ConvertOutputUpToDate(const ConvertImageJob &job)
+{
+    if (!QFile(job.outputFile).exists())
+        return false;
+    QFile sidecar(ConvertSidecarPath(job.outputFile));
+    if (!sidecar.open(QIODevice::ReadOnly))
+        return false;
+    return QString(sidecar.readAll()).trimmed() == job.sourceHash;
+}
+
+static void RemoveConvertSidecar(const ConvertImageJob &job)
+{
+    QFile(ConvertSidecarPath(job.outputFile)).remove();
+}
+
+// Called only after the DDS is committed, the sidecar never describes
+// an output which was not completely written.
+static void StoreConvertSidecar(const ConvertImageJob &job)
+{
+    if (!job.converted)
+        return;
+    QSaveFile sidecar(ConvertSidecarPath(job.outputFile));
+    if (!sidecar.open(QIODevice::WriteOnly))
+        return;
+    sidecar.write((job.sourceHash + "\n").toLatin1());
+    sidecar.commit();
+}
+
 bool CmdLineTools::convertGameImages(MeType gameId, QString &inputDir, QString &outputDir, bool markToConvert)
 {
     QList<TextureMapEntry> textures;
@@ -229,14 +302,90 @@ bool CmdLineTools::convertGameImages(MeType gameId, QString &inputDir, QString &
     outputDir = QDir::cleanPath(outputDir);
     QDir().mkpath(outputDir);
 
-    bool status = true;
+    Misc::startTimer();
+
+    // Sources with the same base name share output, the last one wins as before.
+    QList<ConvertImageJob> jobs;
+    QHash<QString, int> outputIndex;
     foreach (QFileInfo file, list)
     {
-        QString outputFile = outputDir + "/" + BaseNameWithoutExt(file.fileName()) + ".dds";
-        if (!convertGameTexture(gameId, file.absoluteFilePath(), outputFile, textures, markToConvert))
+        ConvertImageJob job{};
+        job.inputFile = file.absoluteFilePath();
+        job.outputFile = outputDir + "/" + BaseNameWithoutExt(file.fileName()) + ".dds";
+        auto index = outputIndex.constFind(job.outputFile.toLower());
+        if (index != outputIndex.constEnd())
+        {
+            jobs[index.value()] = job;
+            continue;
+        }
+        outputIndex.insert(job.outputFile.toLower(), jobs.count());
+        jobs.push_back(job);
+    }
+    int numJobs = jobs.count();
+
+    // Probe sizes and hashes first, then convert small images in a bounded
+    // pool where nested block compression stays single threaded.
+    int threads = qMax(1, qMin(omp_get_max_threads(), numJobs));
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (int i = 0; i < numJobs; i++)
+    {
+        ConvertImageJob &job = jobs[i];
+        int width = 0, height = 0;
+        if (Image::ReadImageSize(job.inputFile, width, height))
+            job.pixels = (qint64)width * height;
+        // unknown size is treated as large, it may need all cores
+        job.large = job.pixels == 0 || job.pixels >= CONVERT_LARGE_IMAGE_PIXELS;
+        job.sourceHash = ConvertSourceHash(job.inputFile, gameId, markToConvert);
+        if (ConvertOutputUpToDate(job))
+        {
+            job.skipped = true;
+            continue;
+        }
+        RemoveConvertSidecar(job);
+        if (job.large)
+            continue;
+        job.converted = convertGameTexture(gameId, job.inputFile, job.outputFile, textures, markToConvert);
+        job.failed = !job.converted;
+        StoreConvertSidecar(job);
+    }
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        ConvertImageJob &job = jobs[i];
+        if (!job.large || job.skipped)
+            continue;
+        job.converted = convertGameTexture(gameId, job.inputFile, job.outputFile, textures, markToConvert);
+        job.failed = !job.converted;
+        StoreConvertSidecar(job);
+    }
+
+    bool status = true;
+    int numConverted = 0, numSkipped = 0, numUnknownSize = 0;
+    qint64 pixels = 0;
+    foreach (const ConvertImageJob &job, jobs)
+    {
+        if (job.failed)
             status = false;
+        if (job.skipped)
+            numSkipped++;
+        if (job.converted)
+        {
+            numConverted++;
+            pixels += job.pixels;
+            if (job.pixels == 0)
+                numUnknownSize++;
+        }
     }
 
+    long elapsed = Misc::elapsedTime();
+    double megaPixels = pixels / 1000000.0;
+    PINFO(QString("Converted %1 images, skipped %2 unchanged, %3 MP in ")
+          .arg(numConverted).arg(numSkipped).arg(megaPixels, 0, 'f', 1) +
+          Misc::getTimerFormat(elapsed) +
+          QString(" (%1 MP/s)\n").arg(elapsed > 0 ? megaPixels * 1000.0 / elapsed : 0.0, 0, 'f', 2));
+    if (numUnknownSize != 0)
+        PINFO(QString("Size of %1 converted images is unknown, not counted in MP\n").arg(numUnknownSize));
+
     return status;
 }
 
@@ -861,9 +1010,265 @@ bool CmdLineTools::RepackTFCInDLC(MeType gameId, QString &dlcName, bool pullText
     return true;
 }
 
+// Export data of textures kept loaded between ordering and extraction pass,
+// shared by all threads extracting packages.
+#define EXTRACT_KEPT_TEXTURES_BYTES (512 * 1024 * 1024)
+
+struct ExtractTextureEntry
+{
+    int exportId;
+    int topIndex;
+    QString storageName;
+    uint offset;
+    Texture *texture;
+};
+
+static bool compareExtractTextureEntry(const ExtractTextureEntry &e1, const ExtractTextureEntry &e2)
+{
+    int compResult = AsciiStringCompareCaseIgnore(e1.storageName, e2.storageName);
+    if (compResult != 0)
+        return compResult < 0;
+    return e1.offset < e2.offset;
+}
+
+static void ReportExtractError(const QString &message)
+{
+    #pragma omp critical(extractTexturesReport)
+    {
+        PERROR(message);
+    }
+}
+
+// Output is named by texture name and CRC only, so the same texture found
+// in several packages is written once, by whichever package claims it first.
+static bool ClaimExtractOutput(QSet<QString> &claimedFiles, const QString &outputFile)
+{
+    bool claimed;
+    #pragma omp critical(extractTexturesClaim)
+    {
+        claimed = !claimedFiles.contains(outputFile) && !QFile(outputFile).exists();
+        if (claimed)
+            claimedFiles.insert(outputFile);
+    }
+    return claimed;
+}
+
+// Returns texture of export if it passes extraction filters, nullptr otherwise.
+static Texture *LoadExtractTexture(Package &package, int exportId, const QString &packagePath, bool png,
+                                   bool pccOnly, bool tfcOnly, const QString &textureTfcFilter)
+{
+    Package::ExportEntry& exp = package.exportsTable[exportId];
+    ByteBuffer exportData = package.getExportData(exportId);
+    if (exportData.ptr() == nullptr)
+    {
+        ReportExtractError(QString("Error: Texture ") + exp.objectName +
+                           " has broken export data in package: " +
+                           packagePath +"\nExport Id: " + QString::number(exportId + 1) + "\nSkipping...\n");
+        return nullptr;
+    }
+    auto texture = new Texture(package, exportId, std::move(exportData));
+    if (!texture->hasImageData())
+    {
+        delete texture;
+        return nullptr;
+    }
+
+    bool tfcPropExists = texture->getProperties().exists("TextureFileCacheName");
+    if ((pccOnly && tfcPropExists) ||
+        (tfcOnly && !tfcPropExists) ||
+        (tfcOnly && !texture->HasExternalMips()))
+    {
+        delete texture;
+        return nullptr;
+    }
+    if (!pccOnly && !tfcOnly && textureTfcFilter.length() != 0)
+    {
+        if (!tfcPropExists ||
+            texture->getProperties().getProperty("TextureFileCacheName").valueName != textureTfcFilter ||
+            !texture->HasExternalMips())
+        {
+            delete texture;
+            return nullptr;
+        }
+    }
+
+    if (!png)
+        texture->removeEmptyMips();
+    return texture;
+}
+
+static int FindExtractTopMipmap(Texture *texture)
+{
+    for (int m = 0; m < texture->mipMapsList.count(); m++)
+    {
+        if (texture->mipMapsList[m].storageType != StorageTypes::empty)
+            return m;
+    }
+    return -1;
+}
+
+static void ExtractPackageTextures(const QString &packagePath, const QString &outputDir, bool png,
+                                   bool pccOnly, bool tfcOnly, const QString &textureTfcFilter,
+                                   const QHash<int, uint> &mapCrcs, FileStreamPool &tfcPool,
+                                   QSet<QString> &claimedFiles, int pngLevel, int pngFilter)
+{
+    Package package;
+    if (package.Open(g_GameData->GamePath() + packagePath) != 0)
+    {
+        ReportExtractError(QString("ERROR: Issue opening package file: ") + packagePath + "\n");
+        return;
+    }
+
+    // Collect storage order of all textures of the package first, then read
+    // them ordered by storage and offset, so external data is read sequentially
+    // from TFC. Textures loaded in export order are kept for the second pass
+    // while they fit in the thread share of memory budget, only the rest is
+    // loaded again, out of package order.
+    qint64 keptBudget = EXTRACT_KEPT_TEXTURES_BYTES / qMax(1, omp_get_num_threads());
+    qint64 keptBytes = 0;
+    QList<ExtractTextureEntry> entries;
+    for (int e = 0; e < package.exportsTable.count(); e++)
+    {
+        int id = package.getClassNameId(package.exportsTable[e].getClassId());
+        if (id != package.nameIdTexture2D &&
+            id != package.nameIdLightMapTexture2D &&
+            id != package.nameIdShadowMapTexture2D &&
+            id != package.nameIdTextureFlipBook)
+        {
+            continue;
+        }
+        Texture *texture = LoadExtractTexture(package, e, packagePath, png, pccOnly, tfcOnly,
+                                              textureTfcFilter);
+        if (texture == nullptr)
+            continue;
+
+        ExtractTextureEntry entry{};
+        entry.exportId = e;
+        entry.topIndex = FindExtractTopMipmap(texture);
+        if (entry.topIndex != -1)
+        {
+            const Texture::TextureMipMap &mipmap = texture->mipMapsList[entry.topIndex];
+            if (mipmap.storageType == StorageTypes::extUnc ||
+                mipmap.storageType == StorageTypes::extLZO ||
+                mipmap.storageType == StorageTypes::extZlib)
+            {
+                if (GameData::gameType == MeType::ME1_TYPE)
+                    entry.storageName = texture->basePackageName;
+                else
+                    entry.storageName = texture->getProperties().getProperty("TextureFileCacheName").valueName;
+                entry.offset = mipmap.dataOffset;
+            }
+            else
+            {
+                entry.offset = mipmap.internalOffset;
+            }
+        }
+        qint64 exportSize = package.exportsTable[e].getDataSize();
+        if (keptBytes + exportSize <= keptBudget)
+        {
+            keptBytes += exportSize;
+            entry.texture = texture;
+        }
+        else
+        {
+            delete texture;
+        }
+        entries.append(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), compareExtractTextureEntry);
+
+    for (int t = 0; t < entries.count(); t++)
+    {
+        const ExtractTextureEntry &entry = entries[t];
+        Texture *texture = entry.texture;
+        if (texture == nullptr)
+        {
+            texture = LoadExtractTexture(package, entry.exportId, packagePath, png, pccOnly, tfcOnly,
+                                         textureTfcFilter);
+        }
+        if (texture == nullptr)
+            continue;
+        QString name = package.exportsTable[entry.exportId].objectName;
+        ByteBuffer topData;
+        if (entry.topIndex != -1)
+            topData = texture->getMipMapDataByIndex(entry.topIndex, &tfcPool);
+        uint crc = mapCrcs.value(entry.exportId, 0);
+        if (crc == 0 && topData.ptr() != nullptr)
+            crc = texture->getCrcData(topData);
+        if (crc == 0)
+        {
+            ReportExtractError(QString("Error: Texture ") + name + " is broken in package: " +
+                               packagePath +"\nExport Id: " + QString::number(entry.exportId + 1) + "\nSkipping...\n");
+            topData.Free();
+            delete texture;
+            continue;
+        }
+        QString outputFile = outputDir + "/" +  name +
+                QString().asprintf("_0x%08X", crc);
+        if (png)
+        {
+            outputFile += ".png";
+        }
+        else
+        {
+            outputFile += ".dds";
+        }
+        if (!ClaimExtractOutput(claimedFiles, outputFile))
+        {
+            topData.Free();
+            delete texture;
+            continue;
+        }
+        PixelFormat pixelFormat = Image::getPixelFormatType(texture->getProperties().getProperty("Format").valueName);
+        if (png)
+        {
+            if (topData.ptr() != nullptr)
+            {
+                const Texture::TextureMipMap &mipmap = texture->mipMapsList[entry.topIndex];
+                Image::saveToPng(topData.ptr(), mipmap.width, mipmap.height, pixelFormat, outputFile,
+                                 pngLevel, pngFilter);
+            }
+        }
+        else
+        {
+            QList<MipMap *> mipmaps = QList<MipMap *>();
+            for (int k = 0; k < texture->mipMapsList.count(); k++)
+            {
+                ByteBuffer data;
+                if (k == entry.topIndex)
+                    data = topData;
+                else
+                    data = texture->getMipMapDataByIndex(k, &tfcPool);
+                if (data.ptr() == nullptr)
+                {
+                    continue;
+                }
+                mipmaps.push_back(new MipMap(data, texture->mipMapsList[k].width, texture->mipMapsList[k].height, pixelFormat));
+                if (k != entry.topIndex)
+                    data.Free();
+            }
+            Image image = Image(mipmaps, pixelFormat);
+            if (image.getMipMaps().count() != 0)
+            {
+                FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
+                image.StoreImageToDDS(fs);
+            }
+            else
+            {
+                ReportExtractError(QString("Texture skipped. Texture ") + name +
+                                   QString().asprintf("_0x%08X", crc) + " is broken in game data!\n");
+            }
+        }
+        topData.Free();
+        delete texture;
+    }
+}
+
 bool CmdLineTools::extractAllTextures(MeType gameId, QString &outputDir, QString &inputFile,
                                       bool png, bool pccOnly, bool tfcOnly, bool mapCrc,
-                                      QString &textureTfcFilter)
+                                      QString &textureTfcFilter, const QString &filter,
+                                      int pngLevel, int pngFilter)
 {
     Resources resources;
     resources.loadMD5Tables();
@@ -872,9 +1277,26 @@ bool CmdLineTools::extractAllTextures(MeType gameId, QString &outputDir, QString
     if (!Misc::CheckGamePath())
         return false;
 
-    QList<TextureMapEntry> textures;
+    // Texture map is turned into per package lookup up front,
+    // instead of searching whole map for every extracted texture.
+    QHash<QString, QHash<int, uint>> mapCrcs;
     if (mapCrc)
+    {
+        QList<TextureMapEntry> textures;
         TreeScan::loadTexturesMap(gameId, resources, textures);
+        for (int k = 0; k < textures.count(); k++)
+        {
+            for (int t = 0; t < textures[k].list.count(); t++)
+            {
+                const TextureMapPackageEntry &entry = textures[k].list[t];
+                if (entry.path.length() == 0)
+                    continue;
+                QHash<int, uint> &packageCrcs = mapCrcs[entry.path];
+                if (!packageCrcs.contains(entry.exportID))
+                    packageCrcs.insert(entry.exportID, textures[k].crc);
+            }
+        }
+    }
 
     QStringList packages;
     if (inputFile != "")
@@ -890,133 +1312,39 @@ bool CmdLineTools::extractAllTextures(MeType gameId, QString &outputDir, QString
     }
     else
     {
-        packages = g_GameData->packageFiles;
+        for (int i = 0; i < g_GameData->packageFiles.count(); i++)
+        {
+            if (filter.length() != 0 &&
+                !g_GameData->packageFiles[i].contains(filter, Qt::CaseInsensitive))
+            {
+                continue;
+            }
+            packages += g_GameData->packageFiles[i];
+        }
     }
 
     QDir().mkpath(outputDir);
 
+    FileStreamPool tfcPool;
+    QSet<QString> claimedFiles;
+    const QHash<int, uint> emptyCrcs;
+    int processedPackages = 0;
+
+    #pragma omp parallel for schedule(dynamic)
     for (int p = 0; p < packages.count(); p++)
     {
-        PINFO(QString("Package ") + QString::number(p + 1) + "/" +
-                             QString::number(packages.count()) + " : " +
-                             packages[p] + "\n");
-
-        Package package;
-        if (package.Open(g_GameData->GamePath() + packages[p]) != 0)
+        #pragma omp critical(extractTexturesReport)
         {
-            PERROR(QString("ERROR: Issue opening package file: ") + packages[p] + "\n");
-            continue;
+            processedPackages++;
+            PINFO(QString("Package ") + QString::number(processedPackages) + "/" +
+                                 QString::number(packages.count()) + " : " +
+                                 packages[p] + "\n");
         }
 
-        for (int e = 0; e < package.exportsTable.count(); e++)
-        {
-            Package::ExportEntry& exp = package.exportsTable[e];
-            int id = package.getClassNameId(exp.getClassId());
-            if (id == package.nameIdTexture2D ||
-                id == package.nameIdLightMapTexture2D ||
-                id == package.nameIdShadowMapTexture2D ||
-                id == package.nameIdTextureFlipBook)
-            {
-                ByteBuffer exportData = package.getExportData(e);
-                if (exportData.ptr() == nullptr)
-                {
-                    PERROR(QString("Error: Texture ") + exp.objectName +
-                                 " has broken export data in package: " +
-                                 packages[p] +"\nExport Id: " + QString::number(e + 1) + "\nSkipping...\n");
-                    continue;
-                }
-                Texture texture(package, e, exportData);
-                exportData.Free();
-                if (!texture.hasImageData())
-                {
-                    continue;
-                }
-
-                bool tfcPropExists = texture.getProperties().exists("TextureFileCacheName");
-                if ((pccOnly && tfcPropExists) ||
-                    (tfcOnly && !tfcPropExists) ||
-                    (tfcOnly && !texture.HasExternalMips()))
-                {
-                    continue;
-                }
-                if (!pccOnly && !tfcOnly && textureTfcFilter.length() != 0)
-                {
-                    if (!tfcPropExists)
-                        continue;
-                    QString archive = texture.getProperties().getProperty("TextureFileCacheName").valueName;
-                    if (archive != textureTfcFilter ||
-                        !texture.HasExternalMips())
-                    {
-                        continue;
-                    }
-                }
-                QString name = exp.objectName;
-                uint crc = 0;
-                if (mapCrc)
-                    crc = Misc::GetCRCFromTextureMap(textures, e, packages[p]);
-                if (crc == 0)
-                    crc = texture.getCrcTopMipmap();
-                if (crc == 0)
-                {
-                    PERROR(QString("Error: Texture ") + name + " is broken in package: " +
-                                 packages[p] +"\nExport Id: " + QString::number(e + 1) + "\nSkipping...\n");
-                    continue;
-                }
-                QString outputFile = outputDir + "/" +  name +
-                        QString().asprintf("_0x%08X", crc);
-                if (png)
-                {
-                    outputFile += ".png";
-                }
-                else
-                {
-                    outputFile += ".dds";
-                }
-                if (QFile(outputFile).exists())
-                    continue;
-                PixelFormat pixelFormat = Image::getPixelFormatType(texture.getProperties().getProperty("Format").valueName);
-                if (png)
-                {
-                    Texture::TextureMipMap mipmap = texture.getTopMipmap();
-                    ByteBuffer data = texture.getTopImageData();
-                    if (data.ptr() != nullptr)
-                    {
-                        if (QFile(outputFile).exists())
-                            QFile(outputFile).remove();
-                        Image::saveToPng(data.ptr(), mipmap.width, mipmap.height, pixelFormat, outputFile);
-                        data.Free();
-                    }
-                }
-                else
-                {
-                    texture.removeEmptyMips();
-                    QList<MipMap *> mipmaps = QList<MipMap *>();
-                    for (int k = 0; k < texture.mipMapsList.count(); k++)
-                    {
-                        ByteBuffer data = texture.getMipMapDataByIndex(k);
-                        if (data.ptr() == nullptr)
-                        {
-                            continue;
-                        }
-                        mipmaps.push_back(new MipMap(data, texture.mipMapsList[k].width, texture.mipMapsList[k].height, pixelFormat));
-                        data.Free();
-                    }
-                    Image image = Image(mipmaps, pixelFormat);
-                    if (image.getMipMaps().count() != 0)
-                    {
-                        if (QFile(outputFile).exists())
-                            QFile(outputFile).remove();
-                        FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
-                        image.StoreImageToDDS(fs);
-                    }
-                    else
-                    {
-                        PERROR(QString("Texture skipped. Texture ") + name +
-                                     QString().asprintf("_0x%08X", crc) + " is broken in game data!\n");
-                    }
-                }
-            }
-        }
+        auto packageCrcs = mapCrcs.constFind(packages[p]);
+        ExtractPackageTextures(packages[p], outputDir, png, pccOnly, tfcOnly, textureTfcFilter,
+                               packageCrcs != mapCrcs.constEnd() ? packageCrcs.value() : emptyCrcs,
+                               tfcPool, claimedFiles, pngLevel, pngFilter);
     }
 
     PINFO("Extracting textures completed.\n\n");
@@ -1440,10 +1768,8 @@ bool CmdLineTools::detectsMismatchPackagesAfter(MeType gameType)
     QString path = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation).first() +
             "/MassEffectModder";
     QString mapFile = path + QString("/me%1map.bin").arg((int)gameType);
-    FileStream fs = FileStream(mapFile, FileMode::Open, FileAccess::ReadOnly);
-    uint tag = fs.ReadUInt32();
-    uint version = fs.ReadUInt32();
-    if (tag != textureMapBinTag || version != textureMapBinVersion)
+    TextureMapFile textureMapFile;
+    if (!textureMapFile.Open(mapFile))
     {
         if (g_ipc)
         {
@@ -1457,28 +1783,8 @@ bool CmdLineTools::detectsMismatchPackagesAfter(MeType gameType)
         return false;
     }
 
-    uint countTexture = fs.ReadUInt32();
-    for (uint i = 0; i < countTexture; i++)
-    {
-        fs.Skip(fs.ReadInt32());
-        fs.SkipInt32();
-        uint countPackages = fs.ReadUInt32();
-        for (uint k = 0; k < countPackages; k++)
-        {
-            fs.Skip(8);
-            fs.Skip(fs.ReadInt32());
-        }
-    }
-
-    QStringList packages = QStringList();
-    int numPackages = fs.ReadInt32();
-    for (int i = 0; i < numPackages; i++)
-    {
-        QString pkgPath;
-        fs.ReadStringASCII(pkgPath, fs.ReadInt32());
-        pkgPath.replace(QChar('\\'), QChar('/'));
-        packages.push_back(pkgPath);
-    }
+    QStringList packages = textureMapFile.ReadPackages();
+    textureMapFile.Close();
     PINFO("Checking for removed files since last game data scan...\n");
     for (int i = 0; i < packages.count(); i++)
     {
@@ -39,7 +39,8 @@ public:
     bool repackGame(MeType gameId);
     bool unpackArchive(const QString &inputFile, QString &outputDir);
     bool applyModTag(MeType gameId, int MeuitmV, int AlotV);
-    bool ConvertToMEM(MeType gameId, QString &inputDir, QString &memFile, bool markToConvert);
+    bool ConvertToMEM(MeType gameId, QString &inputDir, QString &memFile, bool markToConvert,
+                      int memoryBudgetMB, bool useZstd);
     bool convertGameTexture(MeType gameId, const QString &inputFile, QString &outputFile,
                             QList<TextureMapEntry> &textures, bool markToConvert);
     bool convertGameImage(MeType gameId, QString &inputFile, QString &outputFile, bool markToConvert);
@@ -63,7 +64,8 @@ public:
                         bool compressed);
     bool extractAllTextures(MeType gameId, QString &outputDir, QString &inputFile,
                             bool png, bool pccOnly, bool tfcOnly, bool mapCrc,
-                            QString &textureTfcFilter);
+                            QString &textureTfcFilter, const QString &filter,
+                            int pngLevel = -1, int pngFilter = -1);
     bool extractAllMovieTextures(MeType gameId, QString &outputDir, QString &inputFile,
                                     bool pccOnly, bool tfcOnly, bool mapCrc,
                                     QString &textureTfcFilter);
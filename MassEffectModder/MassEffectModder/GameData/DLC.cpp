@@ -21,8 +21,10 @@
 
 #include <Helpers/FileStream.h>
 #include <Helpers/MemoryStream.h>
+#include <Helpers/MmapStream.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/TaskScheduler.h>
 #include <GameData/DLC.h>
 #include <GameData/GameData.h>
 #include <Wrappers.h>
@@ -152,7 +154,7 @@ bool ME3DLC::extract(QString &SFARfilename, int &currentProgress,
         return false;
     }
 
-    std::unique_ptr<Stream> stream (new MemoryStream(SFARfilename));
+    std::unique_ptr<Stream> stream (new MmapStream(SFARfilename, MmapStream::AccessPattern::Sequential));
 
     if (!loadHeader(stream.get()))
         return false;
@@ -224,8 +226,7 @@ bool ME3DLC::extract(QString &SFARfilename, int &currentProgress,
                 }
 
                 bool status = true;
-                #pragma omp parallel for
-                for (uint j = 0; j < filesList[i].numBlocks; j++)
+                TaskScheduler::ParallelFor(TaskScheduler::DLCExtract, (int)filesList[i].numBlocks, [&](int j)
                 {
                     int compressedBlockSize = blockSizes[filesList[i].compressedBlockSizesIndex + j];
                     if (compressedBlockSize == 0 || compressedBlockSize == blockBytesLeft[j])
@@ -242,7 +243,7 @@ bool ME3DLC::extract(QString &SFARfilename, int &currentProgress,
                             status = false;
                         }
                     }
-                }
+                });
 
                 if (!status)
                     return false;
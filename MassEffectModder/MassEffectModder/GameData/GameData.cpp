@@ -21,6 +21,7 @@
 
 #include <GameData/GameData.h>
 #include <Helpers/Exception.h>
+#include <Helpers/IoPolicy.h>
 #include <Helpers/MiscHelpers.h>
 
 MeType GameData::gameType = UNKNOWN_TYPE;
@@ -41,6 +42,8 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
         return;
     }
 
+    IoPolicy::Detect(_path);
+
     if (packageFiles.count() == 0)
     {
 #ifdef GUI
@@ -359,6 +362,7 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
         }
 
         std::sort(packageFiles.begin(), packageFiles.end(), comparePath);
+        packageFilesSet.Build(packageFiles, true);
 
         if (gameType == MeType::ME1_TYPE)
         {
@@ -648,6 +652,7 @@ const QString GameData::RelativeGameData(const QString &path)
 void GameData::ClosePackagesList()
 {
     packageFiles.clear();
+    packageFilesSet.Clear();
     mainFiles.clear();
     DLCFiles.clear();
     tfcFiles.clear();
@@ -22,6 +22,7 @@
 #ifndef GAME_DATA_H
 #define GAME_DATA_H
 
+#include <Helpers/PathSet.h>
 #include <Program/ConfigIni.h>
 #include <Types/MemTypes.h>
 
@@ -110,6 +111,7 @@ private:
 public:
     static MeType gameType;
     QStringList packageFiles;
+    PathSet packageFilesSet;
     QStringList mainFiles;
     QStringList DLCFiles;
     QStringList sfarFiles;
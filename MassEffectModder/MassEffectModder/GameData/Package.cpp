@@ -21,6 +21,10 @@
 
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/MmapStream.h>
+#include <Helpers/TaskScheduler.h>
+#include <Helpers/Trace.h>
 #include <Wrappers.h>
 #include <GameData/GameData.h>
 #include <GameData/Package.h>
@@ -95,6 +99,7 @@ QString Package::resolvePackagePath(int id)
 
 int Package::Open(const QString &filename, bool headerOnly, bool fullLoad)
 {
+    TRACE_SCOPE_NAMED(traceOpen, "Package::Open", "package");
     packagePath = g_GameData->RelativeGameData(filename);
 
     if (!QFile(filename).exists())
@@ -107,13 +112,18 @@ int Package::Open(const QString &filename, bool headerOnly, bool fullLoad)
         PERROR(QString("Package file has 0 length: %1\n").arg(filename));
         return -1;
     }
+    TRACE_BYTES(traceOpen, QFileInfo(filename).size());
     if (QFileInfo(filename).size() < packageHeaderSizeME3)
     {
         PERROR(QString("Broken package header in: %1\n").arg(filename));
         return -1;
     }
 
-    packageStream = new FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
+    // header only reads touch few bytes, mapping pays off for full loads
+    if (headerOnly)
+        packageStream = new FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
+    else
+        packageStream = new MmapStream(filename);
     if (packageStream->ReadUInt32() != DataTag)
     {
         delete packageStream;
@@ -190,7 +200,7 @@ int Package::Open(const QString &filename, bool headerOnly, bool fullLoad)
             CRASH();
 
         uint length = getEndOfTablesOffset() - (uint)dataOffset;
-        packageData = new MemoryStream();
+        packageData = new MemoryStream(static_cast<qint64>(getEndOfTablesOffset()));
         packageData->JumpTo(dataOffset);
         if (!getData((uint)dataOffset, length, packageData))
         {
@@ -266,10 +276,15 @@ bool Package::getData(uint offset, uint length, Stream *outputStream, quint8 *ou
                 startInChunk = offset - chunk.uncomprOffset;
 
             uint bytesLeftInChunk = qMin(chunk.uncomprSize - startInChunk, bytesLeft);
-            if (currentChunk != c)
+            if (currentChunk == c)
+                Metrics::Add(Metrics::ChunkCacheHits);
+            else
             {
+                TRACE_SCOPE_NAMED(traceChunk, "Package::DecompressChunk", "package");
+                TRACE_BYTES(traceChunk, chunk.uncomprSize);
+                Metrics::Add(Metrics::ChunkCacheMisses);
                 delete chunkCache;
-                chunkCache = new MemoryStream();
+                chunkCache = new MemoryStream(static_cast<qint64>(chunk.uncomprSize));
                 currentChunk = c;
                 packageStream->JumpTo(chunk.comprOffset);
                 uint blockTag = packageStream->ReadUInt32(); // block tag
@@ -297,18 +312,27 @@ bool Package::getData(uint offset, uint length, Stream *outputStream, quint8 *ou
                 }
                 chunk.blocks = blocks;
 
+                // mapped package: decompress straight from the mapping
+                auto mappedStream = dynamic_cast<MmapStream *>(packageStream);
+                if (mappedStream)
+                    mappedStream->WillNeed(mappedStream->Position(), compressedChunkSize);
+                std::vector<PooledBuffer> blockBuffers;
+                blockBuffers.reserve(blocks.count() * 2);
                 for (int b = 0; b < blocks.count(); b++)
                 {
                     ChunkBlock block = blocks[b];
-                    block.compressedBuffer = new quint8[block.comprSize];
-                    if (block.compressedBuffer == nullptr)
-                        CRASH_MSG((QString("Out of memory! - amount: ") +
-                                   QString::number(block.comprSize)).toStdString().c_str());
-                    packageStream->ReadToBuffer(block.compressedBuffer, block.comprSize);
-                    block.uncompressedBuffer = new quint8[MaxBlockSize * 2];
-                    if (block.uncompressedBuffer == nullptr)
-                        CRASH_MSG((QString("Out of memory! - amount: ") +
-                                   QString::number(MaxBlockSize * 2)).toStdString().c_str());
+                    if (mappedStream)
+                    {
+                        block.compressedBuffer = const_cast<quint8 *>(mappedStream->Borrow(block.comprSize));
+                    }
+                    else
+                    {
+                        blockBuffers.emplace_back(block.comprSize);
+                        block.compressedBuffer = blockBuffers.back().ptr();
+                        packageStream->ReadToBuffer(block.compressedBuffer, block.comprSize);
+                    }
+                    blockBuffers.emplace_back(MaxBlockSize * 2);
+                    block.uncompressedBuffer = blockBuffers.back().ptr();
                     blocks.replace(b, block);
                 }
 
@@ -326,8 +350,7 @@ bool Package::getData(uint offset, uint length, Stream *outputStream, quint8 *ou
                 }
                 else if (compressionType == CompressionType::Zlib)
                 {
-                    #pragma omp parallel for
-                    for (int b = 0; b < blocks.count(); b++)
+                    TaskScheduler::ParallelFor(TaskScheduler::PackageDecompress, blocks.count(), [&](int b)
                     {
                         const ChunkBlock& block = blocks[b];
                         uint dstLen = MaxBlockSize * 2;
@@ -335,24 +358,21 @@ bool Package::getData(uint offset, uint length, Stream *outputStream, quint8 *ou
                             CRASH_MSG("Out of memory!");
                         if (dstLen != block.uncomprSize)
                             failed = true;
-                    }
+                    });
                 }
                 else
                     CRASH_MSG("Compression type not expected!");
 
+                Metrics::Add(Metrics::ChunksDecoded);
+                Metrics::Add(compressionType == CompressionType::LZO ? Metrics::BytesDecompressedLzo :
+                             Metrics::BytesDecompressedZlib, chunk.uncomprSize);
+
+                if (failed)
+                    return false;
                 for (int b = 0; b < blocks.count(); b++)
                 {
-                    ChunkBlock block = blocks[b];
-                    if (!failed)
-                    {
-                        chunkCache->WriteFromBuffer(block.uncompressedBuffer, block.uncomprSize);
-                        blocks[b] = block;
-                    }
-                    delete[] block.compressedBuffer;
-                    delete[] block.uncompressedBuffer;
+                    chunkCache->WriteFromBuffer(blocks[b].uncompressedBuffer, blocks[b].uncomprSize);
                 }
-                if (failed)
-                    return false;
             }
             chunkCache->JumpTo(startInChunk);
             if (outputStream)
@@ -871,6 +891,7 @@ void Package::saveGuids(Stream &output)
 
 bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appendMarker)
 {
+    TRACE_SCOPE("Package::SaveToFile", "package");
     if (packageFileVersion == packageFileVersionME1)
         forceCompressed = false;
 
@@ -893,7 +914,8 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
             appendMarker = true;
     }
 
-    MemoryStream tempOutput;
+    // export data plus room for the tables, in case they need to move after it
+    MemoryStream tempOutput(static_cast<qint64>(exportsEndOffset) + getEndOfTablesOffset());
     tempOutput.WriteFromBuffer(packageHeader, packageHeaderSize);
     tempOutput.WriteUInt32(targetCompression);
     tempOutput.WriteUInt32(0); // number of chunks - filled later if needed
@@ -1118,6 +1140,8 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
 
             uint dataBlockLeft = chunk.uncomprSize;
             uint newNumBlocks = (chunk.uncomprSize + MaxBlockSize - 1) / MaxBlockSize;
+            Metrics::Add(targetCompression == CompressionType::LZO ? Metrics::BytesCompressedLzo :
+                         Metrics::BytesCompressedZlib, chunk.uncomprSize);
             // skip blocks header and table - filled later
             fs->Seek(SizeOfChunk + SizeOfChunkBlock * newNumBlocks, SeekOrigin::Current);
 
@@ -1136,8 +1160,7 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
                 chunk.blocks.push_back(block);
             }
 
-            #pragma omp parallel for
-            for (int b = 0; b < chunk.blocks.count(); b++)
+            TaskScheduler::ParallelFor(TaskScheduler::PackageCompress, chunk.blocks.count(), [&](int b)
             {
                 ChunkBlock block = chunk.blocks[b];
                 if (targetCompression == CompressionType::LZO)
@@ -1156,7 +1179,7 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
                 if (block.comprSize == 0)
                     CRASH_MSG("Compression failed!");
                 chunk.blocks.replace(b, block);
-            }
+            });
 
             for (uint b = 0; b < newNumBlocks; b++)
             {
@@ -1219,32 +1242,33 @@ void Package::ReleaseChunks()
 
 const ByteBuffer Package::compressData(const ByteBuffer &inputData, StorageTypes type, bool maxCompress)
 {
+    TRACE_SCOPE_NAMED(traceCompress, "Package::compressData", "package");
+    TRACE_BYTES(traceCompress, inputData.size());
+    Metrics::Add(type == StorageTypes::extLZO || type == StorageTypes::pccLZO ?
+                 Metrics::BytesCompressedLzo : Metrics::BytesCompressedZlib, inputData.size());
     MemoryStream ouputStream;
     qint64 compressedSize = 0;
     uint dataBlockLeft = inputData.size();
     uint newNumBlocks = (inputData.size() + MaxBlockSize - 1) / MaxBlockSize;
     QList<Package::ChunkBlock> blocks{};
     {
-        auto inputStream = MemoryStream(inputData);
         // skip blocks header and table - filled later
         ouputStream.Seek(SizeOfChunk + SizeOfChunkBlock * newNumBlocks, SeekOrigin::Begin);
 
+        // blocks are compressed straight from the input buffer
+        qint64 inputOffset = 0;
         for (uint b = 0; b < newNumBlocks; b++)
         {
             Package::ChunkBlock block{};
             block.uncomprSize = qMin((uint)MaxBlockSize, dataBlockLeft);
             dataBlockLeft -= block.uncomprSize;
-            block.uncompressedBuffer = new quint8[block.uncomprSize];
-            if (block.uncompressedBuffer == nullptr)
-                CRASH_MSG((QString("Out of memory! - amount: ") +
-                           QString::number(block.uncomprSize)).toStdString().c_str());
-            inputStream.ReadToBuffer(block.uncompressedBuffer, block.uncomprSize);
+            block.uncompressedBuffer = inputData.ptr() + inputOffset;
+            inputOffset += block.uncomprSize;
             blocks.push_back(block);
         }
     }
 
-    #pragma omp parallel for
-    for (int b = 0; b < blocks.count(); b++)
+    TaskScheduler::ParallelFor(TaskScheduler::PackageCompress, blocks.count(), [&](int b)
     {
         Package::ChunkBlock block = blocks[b];
         if (type == StorageTypes::extLZO || type == StorageTypes::pccLZO)
@@ -1263,7 +1287,7 @@ const ByteBuffer Package::compressData(const ByteBuffer &inputData, StorageTypes
         if (block.comprSize == 0)
             CRASH_MSG("Compression failed!");
         blocks[b] = block;
-    };
+    });
 
     for (int b = 0; b < blocks.count(); b++)
     {
@@ -1283,7 +1307,6 @@ const ByteBuffer Package::compressData(const ByteBuffer &inputData, StorageTypes
         ouputStream.WriteUInt32(block.comprSize);
         ouputStream.WriteUInt32(block.uncomprSize);
         delete[] block.compressedBuffer;
-        delete[] block.uncompressedBuffer;
     }
 
     return ouputStream.ToArray();
@@ -1292,7 +1315,11 @@ const ByteBuffer Package::compressData(const ByteBuffer &inputData, StorageTypes
 const ByteBuffer Package::decompressData(Stream &stream, StorageTypes type,
                                          int uncompressedSize, int compressedSize)
 {
-    auto data = ByteBuffer(uncompressedSize);
+    TRACE_SCOPE_NAMED(traceDecompress, "Package::decompressData", "package");
+    TRACE_BYTES(traceDecompress, uncompressedSize);
+    Metrics::Add(type == StorageTypes::extLZO || type == StorageTypes::pccLZO ?
+                 Metrics::BytesDecompressedLzo : Metrics::BytesDecompressedZlib, uncompressedSize);
+    PooledBuffer data(uncompressedSize);
     uint blockTag = stream.ReadUInt32();
     if (blockTag != DataTag)
     {
@@ -1329,18 +1356,28 @@ const ByteBuffer Package::decompressData(Stream &stream, StorageTypes type,
         blocks.push_back(block);
     }
 
+    // memory backed stream: decompress straight from its buffer
+    auto spanStream = dynamic_cast<SpanStream *>(&stream);
+    auto mappedStream = dynamic_cast<MmapStream *>(&stream);
+    if (mappedStream)
+        mappedStream->WillNeed(mappedStream->Position(), compressedChunkSize);
+    std::vector<PooledBuffer> blockBuffers;
+    blockBuffers.reserve(blocks.count() * 2);
     for (int b = 0; b < blocks.count(); b++)
     {
         Package::ChunkBlock block = blocks[b];
-        block.compressedBuffer = new quint8[blocks[b].comprSize];
-        if (block.compressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(blocks[b].comprSize)).toStdString().c_str());
-        stream.ReadToBuffer(block.compressedBuffer, blocks[b].comprSize);
-        block.uncompressedBuffer = new quint8[MaxBlockSize * 2];
-        if (block.uncompressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(MaxBlockSize * 2)).toStdString().c_str());
+        if (spanStream)
+        {
+            block.compressedBuffer = const_cast<quint8 *>(spanStream->Borrow(blocks[b].comprSize));
+        }
+        else
+        {
+            blockBuffers.emplace_back(blocks[b].comprSize);
+            block.compressedBuffer = blockBuffers.back().ptr();
+            stream.ReadToBuffer(block.compressedBuffer, blocks[b].comprSize);
+        }
+        blockBuffers.emplace_back(MaxBlockSize * 2);
+        block.uncompressedBuffer = blockBuffers.back().ptr();
         blocks[b] = block;
     }
 
@@ -1358,8 +1395,7 @@ const ByteBuffer Package::decompressData(Stream &stream, StorageTypes type,
     }
     else if (type == StorageTypes::extZlib || type == StorageTypes::pccZlib)
     {
-        #pragma omp parallel for
-        for (int b = 0; b < blocks.count(); b++)
+        TaskScheduler::ParallelFor(TaskScheduler::PackageDecompress, blocks.count(), [&](int b)
         {
             uint dstLen = MaxBlockSize * 2;
             Package::ChunkBlock block = blocks[b];
@@ -1367,7 +1403,7 @@ const ByteBuffer Package::decompressData(Stream &stream, StorageTypes type,
                 CRASH_MSG("Out of memory!");
             if (dstLen != block.uncomprSize)
                 errorFlag = true;
-        }
+        });
     }
     else
         CRASH_MSG("Compression type not expected!");
@@ -1383,11 +1419,9 @@ const ByteBuffer Package::decompressData(Stream &stream, StorageTypes type,
     {
         memcpy(data.ptr() + dstPos, blocks[b].uncompressedBuffer, blocks[b].uncomprSize);
         dstPos += blocks[b].uncomprSize;
-        delete[] blocks[b].compressedBuffer;
-        delete[] blocks[b].uncompressedBuffer;
     }
 
-    return data;
+    return ByteBuffer(std::move(data));
 }
 
 void Package::DisposeCache()
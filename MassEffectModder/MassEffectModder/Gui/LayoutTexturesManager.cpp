@@ -19,6 +19,8 @@
  *
  */
 
+#include <chrono>
+
 #include <GameData/GameData.h>
 #include <GameData/TOCFile.h>
 #include <Gui/LayoutMain.h>
@@ -34,6 +36,7 @@
 #include <Misc/Misc.h>
 #include <Texture/Texture.h>
 #include <Texture/TextureMovie.h>
+#include <Texture/TextureMapFile.h>
 
 PixmapLabel::PixmapLabel(QWidget *parent) :
     QLabel(parent)
@@ -270,10 +273,8 @@ bool LayoutTexturesManager::Startup()
     QString filename = path + QString("/me%1map.bin").arg(static_cast<int>(gameType));
     if (QFile::exists(filename))
     {
-        FileStream fs = FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
-        uint tag = fs.ReadUInt32();
-        uint version = fs.ReadUInt32();
-        if (tag != textureMapBinTag || version != textureMapBinVersion)
+        TextureMapFile mapFile;
+        if (!mapFile.Open(filename))
         {
             QMessageBox::critical(this, "Texture Manager",
                                   QString("Detected wrong or old version of textures scan file!") +
@@ -285,73 +286,31 @@ bool LayoutTexturesManager::Startup()
             return false;
         }
 
-        uint countTexture = fs.ReadUInt32();
-        for (uint i = 0; i < countTexture; i++)
-        {
-            fs.Skip(fs.ReadInt32());
-            fs.SkipInt32();
-            uint countPackages = fs.ReadUInt32();
-            for (uint k = 0; k < countPackages; k++)
-            {
-                fs.Skip(8);
-                fs.Skip(fs.ReadInt32());
-            }
-        }
-
-        QStringList packages = QStringList();
-        int numPackages = fs.ReadInt32();
-        for (int i = 0; i < numPackages; i++)
-        {
-            QString pkgPath;
-            fs.ReadStringASCII(pkgPath, fs.ReadInt32());
-            pkgPath.replace(QChar('\\'), QChar('/'));
-            packages.push_back(pkgPath);
-        }
-        for (int i = 0; i < packages.count(); i++)
+        QStringList packages = mapFile.ReadPackages();
+        mapFile.Close();
+        QStringList addedFiles, removedFiles;
+        PathSet(packages).Diff(g_GameData->packageFilesSet, addedFiles, removedFiles);
+        if (removedFiles.count() != 0)
         {
-            bool found = false;
-            for (int f = 0; f < g_GameData->packageFiles.count(); f++)
-            {
-                if (AsciiStringMatchCaseIgnore(g_GameData->packageFiles[f], packages[i]))
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-            {
-                QMessageBox::critical(this, "Texture Manager",
-                                      QString("Detected removal of game files since last game data scan.") +
-                      "\n\nYou need to restore the game to vanilla state then reinstall optional DLC/PCC mods." +
-                      "\n\nThen from the 'Texture Utilities', select 'Delete Textures Scan File' and start Texture Manager again.");
-                mainWindow->statusBar()->clearMessage();
-                buttonExit->setEnabled(true);
-                mainWindow->LockClose(false);
-                return false;
-            }
+            QMessageBox::critical(this, "Texture Manager",
+                                  QString("Detected removal of game files since last game data scan.") +
+                  "\n\nYou need to restore the game to vanilla state then reinstall optional DLC/PCC mods." +
+                  "\n\nThen from the 'Texture Utilities', select 'Delete Textures Scan File' and start Texture Manager again.");
+            mainWindow->statusBar()->clearMessage();
+            buttonExit->setEnabled(true);
+            mainWindow->LockClose(false);
+            return false;
         }
-        for (int i = 0; i < g_GameData->packageFiles.count(); i++)
+        if (addedFiles.count() != 0)
         {
-            bool found = false;
-            for (int f = 0; f < packages.count(); f++)
-            {
-                if (AsciiStringMatchCaseIgnore(packages[f], g_GameData->packageFiles[i]))
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-            {
-                QMessageBox::critical(this, "Texture Manager",
-                                      QString("Detected additional game files not present in latest game data scan.") +
-                      "\n\nYou need to restore the game to vanilla state then reinstall optional DLC/PCC mods." +
-                      "\n\nThen from the 'Texture Utilities', select 'Delete Textures Scan File' and start Texture Manager again.");
-                mainWindow->statusBar()->clearMessage();
-                buttonExit->setEnabled(true);
-                mainWindow->LockClose(false);
-                return false;
-            }
+            QMessageBox::critical(this, "Texture Manager",
+                                  QString("Detected additional game files not present in latest game data scan.") +
+                  "\n\nYou need to restore the game to vanilla state then reinstall optional DLC/PCC mods." +
+                  "\n\nThen from the 'Texture Utilities', select 'Delete Textures Scan File' and start Texture Manager again.");
+            mainWindow->statusBar()->clearMessage();
+            buttonExit->setEnabled(true);
+            mainWindow->LockClose(false);
+            return false;
         }
         if (!TreeScan::loadTexturesMapFile(filename, textures, true))
         {
@@ -593,6 +552,7 @@ bool LayoutTexturesManager::Startup()
             lastPackageName = ViewPackageList[l].packageName;
             lastIndexInTextures = ViewPackageList[l].indexInTextures;
             index++;
+            packageRows.insert(lastPackageName, index);
         }
         else
         {
@@ -606,6 +566,10 @@ bool LayoutTexturesManager::Startup()
         }
     }
     listLeftPackages->setUpdatesEnabled(true);
+
+    mainWindow->statusBar()->showMessage("Preparing search index...");
+    QApplication::processEvents();
+    searchIndex.Build(textures);
     mainWindow->statusBar()->clearMessage();
 
     singlePackageMode = false;
@@ -1474,24 +1438,21 @@ void LayoutTexturesManager::selectFoundTexture(const QListWidgetItem *item)
     leftWidget->setCurrentIndex(kLeftWidgetPackages);
     auto searchTexture = item->data(Qt::UserRole).value<ViewTexture>();
     QString packageName = BaseNameWithoutExt(textures[searchTexture.indexInTextures].list[searchTexture.indexInPackages].path);
-    for (int p = 0; p < listLeftPackages->count(); p++)
+    int p = packageRows.value(packageName, -1);
+    if (p == -1)
+        return;
+    auto itemPackage = listLeftPackages->item(p);
+    itemPackage->setSelected(true);
+    listLeftPackages->setCurrentRow(p);
+    for (int t = 0; t < listMiddle->count(); t++)
     {
-        auto itemPackage = listLeftPackages->item(p);
-        if (itemPackage->text() == packageName)
+        auto searchItem = listMiddle->item(t);
+        auto viewTexture = searchItem->data(Qt::UserRole).value<ViewTexture>();
+        if (viewTexture.indexInTextures == searchTexture.indexInTextures)
         {
-            itemPackage->setSelected(true);
-            listLeftPackages->setCurrentRow(p);
-            for (int t = 0; t < listMiddle->count(); t++)
-            {
-                auto searchItem = listMiddle->item(t);
-                auto viewTexture = searchItem->data(Qt::UserRole).value<ViewTexture>();
-                if (viewTexture.indexInTextures == searchTexture.indexInTextures)
-                {
-                    searchItem->setSelected(true);
-                    listMiddle->setCurrentRow(t);
-                    return;
-                }
-            }
+            searchItem->setSelected(true);
+            listMiddle->setCurrentRow(t);
+            return;
         }
     }
 }
@@ -1508,53 +1469,58 @@ void LayoutTexturesManager::SearchListSelected(QListWidgetItem *item)
 
 void LayoutTexturesManager::SearchTexture(const QString &name, uint crc)
 {
-    listLeftSearch->setUpdatesEnabled(false);
-    listLeftSearch->clear();
-    for (int l = 0; l < textures.count(); l++)
+    QVector<int> foundTextures;
+    if (name != "")
     {
-        const TextureMapEntry& foundTexture = textures[l];
-        bool found = false;
-        if (name != "")
+        if (searchIndex.IsExpensive(name))
         {
-            if (name.contains("*"))
+            // wide wildcard pattern, keep the window responsive meanwhile
+            std::atomic<bool> done(false);
+            std::thread worker([&]()
             {
-                QRegExp regex(name.toLower());
-                regex.setPatternSyntax(QRegExp::Wildcard);
-                if (regex.exactMatch(foundTexture.name.toLower()))
-                {
-                    found = true;
-                }
-            }
-            else if (foundTexture.name.toLower() == name.toLower())
+                foundTextures = searchIndex.FindByName(name);
+                done = true;
+            });
+            while (!done)
             {
-                found = true;
+                QApplication::processEvents();
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
+            worker.join();
         }
-        else if (crc != 0 && foundTexture.crc == crc)
+        else
         {
-            found = true;
+            foundTextures = searchIndex.FindByName(name);
         }
-        if (found)
+    }
+    else if (crc != 0)
+    {
+        foundTextures = searchIndex.FindByCrc(crc);
+    }
+
+    listLeftSearch->setUpdatesEnabled(false);
+    listLeftSearch->clear();
+    for (int l : foundTextures)
+    {
+        const TextureMapEntry& foundTexture = textures[l];
+        TextureMapPackageEntry nodeTexture;
+        int indexInPackages;
+        for (indexInPackages = 0; indexInPackages < foundTexture.list.count(); indexInPackages++)
         {
-            TextureMapPackageEntry nodeTexture;
-            int indexInPackages;
-            for (indexInPackages = 0; indexInPackages < foundTexture.list.count(); indexInPackages++)
+            if (foundTexture.list[indexInPackages].path.length() != 0)
             {
-                if (foundTexture.list[indexInPackages].path.length() != 0)
-                {
-                    nodeTexture = foundTexture.list[indexInPackages];
-                    break;
-                }
+                nodeTexture = foundTexture.list[indexInPackages];
+                break;
             }
-            auto item = new QListWidgetItem(foundTexture.name +
-                                            " (" + BaseNameWithoutExt(nodeTexture.path) + ")");
-            ViewTexture texture;
-            texture.name = foundTexture.name;
-            texture.indexInTextures = l;
-            texture.indexInPackages = indexInPackages;
-            item->setData(Qt::UserRole, QVariant::fromValue<ViewTexture>(texture));
-            listLeftSearch->addItem(item);
         }
+        auto item = new QListWidgetItem(foundTexture.name +
+                                        " (" + BaseNameWithoutExt(nodeTexture.path) + ")");
+        ViewTexture texture;
+        texture.name = foundTexture.name;
+        texture.indexInTextures = l;
+        texture.indexInPackages = indexInPackages;
+        item->setData(Qt::UserRole, QVariant::fromValue<ViewTexture>(texture));
+        listLeftSearch->addItem(item);
     }
     listLeftSearch->sortItems();
     listLeftSearch->setUpdatesEnabled(true);
@@ -23,6 +23,7 @@
 #define LAYOUT_TEXTURES_MANAGER_H
 
 #include <Gui/MainWindow.h>
+#include <Gui/TextureSearchIndex.h>
 #include <Image/Image.h>
 #include <Program/ConfigIni.h>
 #include <Resources/Resources.h>
@@ -135,6 +136,8 @@ private:
 
     ConfigIni      configIni{};
     QList<TextureMapEntry> textures;
+    TextureSearchIndex searchIndex;
+    QHash<QString, int> packageRows;
     Resources      resources;
     MeType         gameType;
 
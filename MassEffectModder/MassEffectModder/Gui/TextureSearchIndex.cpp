@@ -0,0 +1,131 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <QSet>
+
+#include <Gui/TextureSearchIndex.h>
+
+static const QRegularExpression wildcardCharsRegex("[*?\\[\\]]");
+static const QRegularExpression wildcardSetRegex("\\[[^\\]]*\\]");
+
+// names are ASCII, other characters only make false candidates
+quint32 TextureSearchIndex::Trigram(const QString &str, int pos)
+{
+    return (str[pos].unicode() & 0xFF) |
+           ((str[pos + 1].unicode() & 0xFF) << 8) |
+           ((str[pos + 2].unicode() & 0xFF) << 16);
+}
+
+void TextureSearchIndex::Build(const QList<TextureMapEntry> &textures)
+{
+    Clear();
+    lowerNames.reserve(textures.count());
+    for (int t = 0; t < textures.count(); t++)
+    {
+        QString name = textures[t].name.toLower();
+        lowerNames.append(name);
+        namesMap[name].append(t);
+        crcMap[textures[t].crc].append(t);
+
+        QSet<quint32> trigrams;
+        for (int c = 0; c + 3 <= name.length(); c++)
+            trigrams.insert(Trigram(name, c));
+        foreach (quint32 trigram, trigrams)
+            trigramsMap[trigram].append(t);
+    }
+}
+
+void TextureSearchIndex::Clear()
+{
+    lowerNames.clear();
+    namesMap.clear();
+    crcMap.clear();
+    trigramsMap.clear();
+    lastPattern.clear();
+    lastResults.clear();
+}
+
+QVector<int> TextureSearchIndex::FindByCrc(uint crc) const
+{
+    return crcMap.value(crc);
+}
+
+// Smallest posting list of trigrams from literal parts of pattern,
+// or all textures if pattern has no literal part of three characters.
+QVector<int> TextureSearchIndex::Candidates(const QString &pattern) const
+{
+    const QVector<int> *best = nullptr;
+    QString literalsPattern = pattern;
+    literalsPattern.replace(wildcardSetRegex, "?");
+    QStringList literals = literalsPattern.split(wildcardCharsRegex, QString::SkipEmptyParts);
+    foreach (const QString &literal, literals)
+    {
+        for (int c = 0; c + 3 <= literal.length(); c++)
+        {
+            auto it = trigramsMap.constFind(Trigram(literal, c));
+            if (it == trigramsMap.constEnd())
+                return QVector<int>();
+            if (best == nullptr || it.value().count() < best->count())
+                best = &it.value();
+        }
+    }
+    if (best != nullptr)
+        return *best;
+
+    QVector<int> all(lowerNames.count());
+    for (int t = 0; t < all.count(); t++)
+        all[t] = t;
+    return all;
+}
+
+QVector<int> TextureSearchIndex::FindByName(const QString &name)
+{
+    QString pattern = name.toLower();
+    if (!pattern.contains('*'))
+        return namesMap.value(pattern);
+
+    // "abc*" matches everything "abcd*" can match, check only previous results
+    QVector<int> candidates;
+    if (lastPattern.endsWith('*') && pattern.startsWith(lastPattern.left(lastPattern.length() - 1)))
+        candidates = lastResults;
+    else
+        candidates = Candidates(pattern);
+
+    QRegExp regex(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+    QVector<int> results;
+    for (int t : candidates)
+    {
+        if (regex.exactMatch(lowerNames[t]))
+            results.append(t);
+    }
+
+    lastPattern = pattern;
+    lastResults = results;
+    return results;
+}
+
+bool TextureSearchIndex::IsExpensive(const QString &name) const
+{
+    QString pattern = name.toLower();
+    if (!pattern.contains('*'))
+        return false;
+    return Candidates(pattern).count() > BackgroundSearchThreshold;
+}
@@ -0,0 +1,62 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEXTURE_SEARCH_INDEX_H
+#define TEXTURE_SEARCH_INDEX_H
+
+#include <QHash>
+#include <QVector>
+
+#include <Texture/TextureScan.h>
+
+// Lookup tables over the textures map, built once after the map is loaded.
+// Exact names and CRCs are plain hash lookups. Wildcard names only check
+// textures sharing a trigram with the literal part of the pattern, and a
+// pattern typed further from the previous one only rechecks its results.
+class TextureSearchIndex
+{
+private:
+
+    QVector<QString>              lowerNames;
+    QHash<QString, QVector<int>>  namesMap;
+    QHash<uint, QVector<int>>     crcMap;
+    QHash<quint32, QVector<int>>  trigramsMap;
+    QString                       lastPattern;
+    QVector<int>                  lastResults;
+
+    static quint32 Trigram(const QString &str, int pos);
+    QVector<int> Candidates(const QString &pattern) const;
+
+public:
+
+    enum
+    {
+        BackgroundSearchThreshold = 10000,
+    };
+
+    void Build(const QList<TextureMapEntry> &textures);
+    void Clear();
+    QVector<int> FindByCrc(uint crc) const;
+    QVector<int> FindByName(const QString &name);
+    bool IsExpensive(const QString &name) const;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <vector>
+
+#include "BufferPool.h"
+
+struct BufferPoolClass
+{
+    std::mutex lock;
+    std::vector<quint8 *> buffers;
+};
+
+struct BufferPoolGlobal
+{
+    BufferPoolClass classes[BufferPool::ClassesCount];
+    std::atomic<quint64> maxBytesRetained{ (quint64)BufferPool::DefaultMaxRetainedMB * 1024 * 1024 };
+    std::atomic<quint64> bytesRetained{};
+    std::atomic<quint64> peakBytesRetained{};
+    std::atomic<quint64> hits{};
+    std::atomic<quint64> misses{};
+    std::atomic<quint64> releases{};
+    std::atomic<quint64> discards{};
+};
+
+// never destroyed, worker threads may still return buffers at process exit
+static BufferPoolGlobal *GetGlobalPool()
+{
+    static auto pool = new BufferPoolGlobal;
+    return pool;
+}
+
+static int GetSizeClass(quint64 size)
+{
+    if (size <= (1ULL << (BufferPool::MinClassShift - 1)) ||
+        size > (1ULL << BufferPool::MaxClassShift))
+    {
+        return -1;
+    }
+    int shift = BufferPool::MinClassShift;
+    while ((1ULL << shift) < size)
+        shift++;
+    return shift - BufferPool::MinClassShift;
+}
+
+static quint64 GetClassSize(int sizeClass)
+{
+    return 1ULL << (sizeClass + BufferPool::MinClassShift);
+}
+
+static void ReturnToGlobalPool(int sizeClass, quint8 *ptr)
+{
+    BufferPoolClass &poolClass = GetGlobalPool()->classes[sizeClass];
+    std::lock_guard<std::mutex> guard(poolClass.lock);
+    poolClass.buffers.push_back(ptr);
+}
+
+struct BufferPoolThreadCache
+{
+    quint8 *buffers[BufferPool::ClassesCount][BufferPool::ThreadCacheDepth]{};
+    int counts[BufferPool::ClassesCount]{};
+
+    ~BufferPoolThreadCache()
+    {
+        for (int c = 0; c < BufferPool::ClassesCount; c++)
+        {
+            for (int i = 0; i < counts[c]; i++)
+                ReturnToGlobalPool(c, buffers[c][i]);
+        }
+    }
+};
+
+static thread_local BufferPoolThreadCache g_threadCache;
+
+quint8 *BufferPool::Allocate(quint64 size)
+{
+    quint8 *ptr;
+    int sizeClass = GetSizeClass(size);
+    if (sizeClass == -1)
+    {
+        ptr = new quint8[size];
+        if (ptr == nullptr)
+            CRASH_MSG((QString("BufferPool: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
+        return ptr;
+    }
+
+    BufferPoolGlobal *pool = GetGlobalPool();
+    BufferPoolThreadCache &cache = g_threadCache;
+    if (cache.counts[sizeClass] != 0)
+    {
+        pool->hits++;
+        pool->bytesRetained -= GetClassSize(sizeClass);
+        return cache.buffers[sizeClass][--cache.counts[sizeClass]];
+    }
+
+    {
+        BufferPoolClass &poolClass = pool->classes[sizeClass];
+        std::lock_guard<std::mutex> guard(poolClass.lock);
+        if (!poolClass.buffers.empty())
+        {
+            ptr = poolClass.buffers.back();
+            poolClass.buffers.pop_back();
+            pool->hits++;
+            pool->bytesRetained -= GetClassSize(sizeClass);
+            return ptr;
+        }
+    }
+
+    pool->misses++;
+    ptr = new quint8[GetClassSize(sizeClass)];
+    if (ptr == nullptr)
+        CRASH_MSG((QString("BufferPool: Out of memory! - amount: ") + QString::number(GetClassSize(sizeClass))).toStdString().c_str());
+    return ptr;
+}
+
+void BufferPool::Release(quint8 *ptr, quint64 size)
+{
+    if (ptr == nullptr)
+        return;
+
+    int sizeClass = GetSizeClass(size);
+    if (sizeClass == -1)
+    {
+        delete[] ptr;
+        return;
+    }
+
+    BufferPoolGlobal *pool = GetGlobalPool();
+    pool->releases++;
+    quint64 classSize = GetClassSize(sizeClass);
+    quint64 retained = pool->bytesRetained.fetch_add(classSize) + classSize;
+    if (retained > pool->maxBytesRetained)
+    {
+        pool->bytesRetained -= classSize;
+        pool->discards++;
+        delete[] ptr;
+        return;
+    }
+    quint64 peak = pool->peakBytesRetained;
+    while (retained > peak && !pool->peakBytesRetained.compare_exchange_weak(peak, retained))
+    {
+    }
+
+    BufferPoolThreadCache &cache = g_threadCache;
+    if (cache.counts[sizeClass] < ThreadCacheDepth)
+    {
+        cache.buffers[sizeClass][cache.counts[sizeClass]++] = ptr;
+        return;
+    }
+    ReturnToGlobalPool(sizeClass, ptr);
+}
+
+void BufferPool::SetMaxRetainedBytes(quint64 bytes)
+{
+    GetGlobalPool()->maxBytesRetained = bytes;
+    Trim();
+}
+
+// Frees buffers kept in the global lists, per thread caches are left intact.
+void BufferPool::Trim()
+{
+    BufferPoolGlobal *pool = GetGlobalPool();
+    for (int c = 0; c < ClassesCount; c++)
+    {
+        BufferPoolClass &poolClass = pool->classes[c];
+        std::lock_guard<std::mutex> guard(poolClass.lock);
+        for (auto ptr : poolClass.buffers)
+        {
+            delete[] ptr;
+            pool->bytesRetained -= GetClassSize(c);
+        }
+        poolClass.buffers.clear();
+    }
+}
+
+BufferPool::Stats BufferPool::GetStats()
+{
+    BufferPoolGlobal *pool = GetGlobalPool();
+    Stats stats{};
+    stats.hits = pool->hits;
+    stats.misses = pool->misses;
+    stats.releases = pool->releases;
+    stats.discards = pool->discards;
+    stats.bytesRetained = pool->bytesRetained;
+    stats.peakBytesRetained = pool->peakBytesRetained;
+    return stats;
+}
+
+void BufferPool::ResetStats()
+{
+    BufferPoolGlobal *pool = GetGlobalPool();
+    pool->hits = 0;
+    pool->misses = 0;
+    pool->releases = 0;
+    pool->discards = 0;
+    pool->peakBytesRetained = pool->bytesRetained.load();
+}
@@ -0,0 +1,134 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <Helpers/Exception.h>
+
+// Process wide pool of large buffers grouped in power of two size classes.
+// Each thread keeps a few buffers per class for itself and shares the rest
+// through the global lists, so codec and mipmap paths allocating the same
+// sizes over and over reuse memory instead of going to the heap.
+// Memory from the pool is allocated with new[], so it can be also freed
+// with delete[] when it does not go back to the pool.
+class BufferPool
+{
+public:
+
+    enum
+    {
+        MinClassShift = 16, // 64KB, buffers up to half of it are not pooled
+        MaxClassShift = 26, // 64MB, bigger buffers are not pooled
+        ClassesCount = MaxClassShift - MinClassShift + 1,
+        ThreadCacheDepth = 2,
+        DefaultMaxRetainedMB = 256,
+    };
+
+    struct Stats
+    {
+        quint64 hits;
+        quint64 misses;
+        quint64 releases;
+        quint64 discards;
+        quint64 bytesRetained;
+        quint64 peakBytesRetained;
+    };
+
+    static quint8 *Allocate(quint64 size);
+    static void Release(quint8 *ptr, quint64 size);
+    static void SetMaxRetainedBytes(quint64 bytes);
+    static void Trim();
+    static Stats GetStats();
+    static void ResetStats();
+};
+
+// Owning handle of pooled memory, returns it to the pool on destruction.
+class PooledBuffer
+{
+private:
+
+    quint8 *_ptr = nullptr;
+    quint64 _size = 0;
+
+public:
+
+    PooledBuffer() = default;
+    explicit PooledBuffer(quint64 size)
+        : _ptr(BufferPool::Allocate(size)), _size(size)
+    {
+    }
+    PooledBuffer(const PooledBuffer &) = delete;
+    PooledBuffer &operator=(const PooledBuffer &) = delete;
+
+    PooledBuffer(PooledBuffer &&other) noexcept
+        : _ptr(other._ptr), _size(other._size)
+    {
+        other._ptr = nullptr;
+        other._size = 0;
+    }
+
+    PooledBuffer &operator=(PooledBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            _ptr = other._ptr;
+            _size = other._size;
+            other._ptr = nullptr;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    ~PooledBuffer()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        BufferPool::Release(_ptr, _size);
+        _ptr = nullptr;
+        _size = 0;
+    }
+
+    // Gives up ownership, the memory must be handed back with BufferPool::Release().
+    quint8 *Detach()
+    {
+        quint8 *ptr = _ptr;
+        _ptr = nullptr;
+        _size = 0;
+        return ptr;
+    }
+
+    [[nodiscard]] quint8 *ptr() const
+    {
+        return _ptr;
+    }
+
+    [[nodiscard]] quint64 size() const
+    {
+        return _size;
+    }
+};
+
+#endif
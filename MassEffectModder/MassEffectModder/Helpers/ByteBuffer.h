@@ -23,6 +23,7 @@
 #define BYTE_BUFFER_H
 
 #include <Helpers/Exception.h>
+#include <Helpers/BufferPool.h>
 
 struct ByteBuffer
 {
@@ -30,6 +31,7 @@ private:
 
     quint8 *_ptr;
     qint64 _size;
+    bool _pooled;
 
 public:
 
@@ -37,6 +39,7 @@ public:
     {
         _ptr = nullptr;
         _size = 0;
+        _pooled = false;
     }
 
     ByteBuffer(quint64 size)
@@ -45,6 +48,7 @@ public:
         if (_ptr == nullptr)
             CRASH_MSG((QString("ByteBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
         _size = size;
+        _pooled = false;
     }
 
     ByteBuffer(const quint8 *ptr, quint64 size)
@@ -54,11 +58,23 @@ public:
             CRASH_MSG((QString("ByteBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
         memcpy(_ptr, ptr, size);
         _size = size;
+        _pooled = false;
+    }
+
+    // Adopts pooled memory, Free() hands it back to the pool.
+    explicit ByteBuffer(PooledBuffer &&buffer)
+    {
+        _size = buffer.size();
+        _ptr = buffer.Detach();
+        _pooled = true;
     }
 
     void Free()
     {
-        delete[] _ptr;
+        if (_pooled)
+            BufferPool::Release(_ptr, _size);
+        else
+            delete[] _ptr;
         _ptr = nullptr;
     }
 
@@ -19,6 +19,10 @@
 
 #include "Crc32.h"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 // define endianess and some integer data types
 #if defined(_MSC_VER) || defined(__MINGW32__) || defined (__i386__) || defined(__x86_64__)
   #define __LITTLE_ENDIAN 1234
@@ -515,6 +519,265 @@ uint32_t crc32_fast(const void* data, size_t length, uint32_t previousCrc32)
 }
 
 
+// //////////////////////////////////////////////////////////
+// hardware accelerated CRC32 (PCLMULQDQ folding) and combining
+
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #define CRC32_USE_PCLMUL
+  #include <cpuid.h>
+  #include <emmintrin.h>
+  #include <smmintrin.h>
+  #include <wmmintrin.h>
+  #define CRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#endif
+
+/// bytes handled by PCLMULQDQ code path must be at least 64 and multiple of 16
+const size_t PclmulMinLength = 64;
+
+/// below this size crc32_parallel doesn't split work between threads
+const size_t ParallelMinLength = 4 * 1024 * 1024;
+
+
+/// true if CPU supports instructions needed by crc32_pclmul
+bool crc32_pclmul_supported()
+{
+#ifdef CRC32_USE_PCLMUL
+  static const bool supported = []
+  {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+    return (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSE4_1) != 0;
+  }();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+
+#ifdef CRC32_USE_PCLMUL
+/// fold 16-byte blocks with carry-less multiplication, "crc" is raw (not inverted) state,
+/// based on Intel's "Fast CRC Computation Using PCLMULQDQ Instruction" with the
+/// bit-reflected constants of the zlib polynomial, length >= 64 and multiple of 16
+CRC32_TARGET_PCLMUL
+static uint32_t crc32_pclmul_fold(const uint8_t* current, size_t length, uint32_t crc)
+{
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+  const __m128i k5k0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+  const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i*) (current + 0x00));
+  x2 = _mm_loadu_si128((const __m128i*) (current + 0x10));
+  x3 = _mm_loadu_si128((const __m128i*) (current + 0x20));
+  x4 = _mm_loadu_si128((const __m128i*) (current + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crc));
+  current += 64;
+  length  -= 64;
+
+  // fold 4 x 128 bits in parallel
+  x0 = k1k2;
+  while (length >= 64)
+  {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*) (current + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*) (current + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*) (current + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*) (current + 0x30)));
+    current += 64;
+    length  -= 64;
+  }
+
+  // fold into 128 bits
+  x0 = k3k4;
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // remaining 16 byte blocks
+  while (length >= 16)
+  {
+    x2 = _mm_loadu_si128((const __m128i*) current);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    current += 16;
+    length  -= 16;
+  }
+
+  // fold 128 bits to 64 bits
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_srli_si128(x1, 8);
+  x1 = _mm_xor_si128(x1, x2);
+
+  x0 = k5k0;
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0 = poly;
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return (uint32_t) _mm_extract_epi32(x1, 1);
+}
+#endif
+
+
+/// compute CRC32 (PCLMULQDQ folding), caller must check crc32_pclmul_supported()
+uint32_t crc32_pclmul(const void* data, size_t length, uint32_t previousCrc32)
+{
+#ifdef CRC32_USE_PCLMUL
+  if (length < PclmulMinLength)
+    return crc32_16bytes(data, length, previousCrc32);
+
+  const uint8_t* current = (const uint8_t*) data;
+  size_t folded = length & ~(size_t) 15;
+  uint32_t crc = crc32_pclmul_fold(current, folded, ~previousCrc32);
+
+  // remaining 1 to 15 bytes
+  return crc32_16bytes(current + folded, length - folded, ~crc);
+#else
+  return crc32_16bytes(data, length, previousCrc32);
+#endif
+}
+
+
+/// compute CRC32 using the fastest algorithm supported by current CPU (runtime dispatch)
+uint32_t crc32_hw(const void* data, size_t length, uint32_t previousCrc32)
+{
+  if (crc32_pclmul_supported())
+    return crc32_pclmul(data, length, previousCrc32);
+  return crc32_16bytes_prefetch(data, length, previousCrc32);
+}
+
+
+/// multiply 32x32 GF(2) matrix by vector
+static uint32_t gf2_matrix_times(const uint32_t* matrix, uint32_t vector)
+{
+  uint32_t sum = 0;
+  while (vector != 0)
+  {
+    if (vector & 1)
+      sum ^= *matrix;
+    vector >>= 1;
+    matrix++;
+  }
+  return sum;
+}
+
+/// square 32x32 GF(2) matrix
+static void gf2_matrix_square(uint32_t* square, const uint32_t* matrix)
+{
+  for (int n = 0; n < 32; n++)
+    square[n] = gf2_matrix_times(matrix, matrix[n]);
+}
+
+
+/// combine CRC32 of two consecutive blocks (same as zlib's crc32_combine)
+uint32_t crc32_combine_blocks(uint32_t crcA, uint32_t crcB, size_t lengthB)
+{
+  if (lengthB == 0)
+    return crcA;
+
+  uint32_t even[32]; // even-power-of-two zeros operator
+  uint32_t odd [32]; // odd-power-of-two zeros operator
+
+  // operator for one zero bit
+  odd[0] = Polynomial;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++)
+  {
+    odd[n] = row;
+    row <<= 1;
+  }
+
+  // operator for two and four zero bits
+  gf2_matrix_square(even, odd);
+  gf2_matrix_square(odd, even);
+
+  // apply lengthB zero bytes to crcA
+  do
+  {
+    gf2_matrix_square(even, odd);
+    if (lengthB & 1)
+      crcA = gf2_matrix_times(even, crcA);
+    lengthB >>= 1;
+    if (lengthB == 0)
+      break;
+
+    gf2_matrix_square(odd, even);
+    if (lengthB & 1)
+      crcA = gf2_matrix_times(odd, crcA);
+    lengthB >>= 1;
+  } while (lengthB != 0);
+
+  return crcA ^ crcB;
+}
+
+
+/// compute CRC32 of large buffer in parallel chunks, partial results merged by crc32_combine_blocks
+uint32_t crc32_parallel(const void* data, size_t length, uint32_t previousCrc32)
+{
+  int numChunks = 1;
+#ifdef _OPENMP
+  if (length >= ParallelMinLength)
+  {
+    numChunks = omp_get_max_threads();
+    if ((size_t) numChunks > length / (ParallelMinLength / 4))
+      numChunks = (int) (length / (ParallelMinLength / 4));
+  }
+#endif
+  if (numChunks <= 1)
+    return crc32_hw(data, length, previousCrc32);
+
+  uint32_t partial[256];
+  if (numChunks > 256)
+    numChunks = 256;
+  const uint8_t* current = (const uint8_t*) data;
+  size_t chunkLength = (length / numChunks) & ~(size_t) 63;
+
+  #pragma omp parallel for
+  for (int i = 0; i < numChunks; i++)
+  {
+    size_t offset = i * chunkLength;
+    size_t size = (i == numChunks - 1) ? length - offset : chunkLength;
+    partial[i] = crc32_hw(current + offset, size, i == 0 ? previousCrc32 : 0);
+  }
+
+  uint32_t crc = partial[0];
+  for (int i = 1; i < numChunks; i++)
+  {
+    size_t size = (i == numChunks - 1) ? length - i * chunkLength : chunkLength;
+    crc = crc32_combine_blocks(crc, partial[i], size);
+  }
+  return crc;
+}
+
+
 // //////////////////////////////////////////////////////////
 // constants
 
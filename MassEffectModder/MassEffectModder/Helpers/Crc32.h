@@ -64,3 +64,14 @@ uint32_t crc32_16bytes (const void* data, size_t length, uint32_t previousCrc32
 /// compute CRC32 (Slicing-by-16 algorithm, prefetch upcoming data blocks)
 uint32_t crc32_16bytes_prefetch(const void* data, size_t length, uint32_t previousCrc32 = 0, size_t prefetchAhead = 256);
 #endif
+
+/// true if CPU supports PCLMULQDQ and SSE4.1 used by crc32_pclmul
+bool crc32_pclmul_supported();
+/// compute CRC32 (PCLMULQDQ folding), needs crc32_pclmul_supported()
+uint32_t crc32_pclmul(const void* data, size_t length, uint32_t previousCrc32 = 0);
+/// compute CRC32 using the fastest algorithm supported by current CPU (runtime dispatch)
+uint32_t crc32_hw(const void* data, size_t length, uint32_t previousCrc32 = 0);
+/// combine CRC32 of two consecutive blocks, lengthB is length of the second block
+uint32_t crc32_combine_blocks(uint32_t crcA, uint32_t crcB, size_t lengthB);
+/// compute CRC32, large buffers are split between threads and partial CRCs combined
+uint32_t crc32_parallel(const void* data, size_t length, uint32_t previousCrc32 = 0);
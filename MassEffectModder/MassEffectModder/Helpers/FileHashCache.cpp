@@ -0,0 +1,217 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include <QHash>
+#include <QSaveFile>
+
+#include "FileHashCache.h"
+#include <Helpers/MemoryStream.h>
+#include <Helpers/Logs.h>
+
+struct FileHashEntry
+{
+    FileHashStatus status;
+    QByteArray md5;
+    bool stored;
+};
+
+static QHash<QString, FileHashEntry> g_entries;
+static QString g_cacheFile;
+static QString g_rootPath;
+static bool g_ignoreStored = false;
+static bool g_dirty = false;
+static std::mutex g_lock;
+
+static bool getFileStatus(const QString &filePath, FileHashStatus &status)
+{
+#if defined(_WIN32)
+    QFileInfo info(filePath);
+    if (!info.exists())
+        return false;
+    status.size = info.size();
+    status.modifiedNs = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    status.fileId = 0;
+#else
+    struct stat st;
+    if (stat(filePath.toUtf8().constData(), &st) != 0)
+        return false;
+    status.size = st.st_size;
+#if defined(__APPLE__)
+    status.modifiedNs = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    status.modifiedNs = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    status.fileId = st.st_ino;
+#endif
+    return true;
+}
+
+static bool sameStatus(const FileHashStatus &a, const FileHashStatus &b)
+{
+    return a.size == b.size && a.modifiedNs == b.modifiedNs && a.fileId == b.fileId;
+}
+
+static QString relativePath(const QString &filePath)
+{
+    if (g_rootPath.length() != 0 && filePath.startsWith(g_rootPath, Qt::CaseInsensitive))
+        return filePath.mid(g_rootPath.length());
+    return filePath;
+}
+
+static void loadEntries()
+{
+    g_entries.clear();
+    g_dirty = false;
+    if (!QFile(g_cacheFile).exists())
+        return;
+
+    MemoryStream stream(g_cacheFile);
+    if (stream.Length() < 12 || stream.ReadUInt32() != FileHashCache::CacheTag ||
+        stream.ReadUInt32() != FileHashCache::CacheVersion)
+    {
+        PINFO("Hash cache has wrong format, ignoring it: " + g_cacheFile + "\n");
+        return;
+    }
+    uint count = stream.ReadUInt32();
+    for (uint i = 0; i < count; i++)
+    {
+        if (stream.Length() - stream.Position() < 4)
+            break;
+        qint64 length = stream.ReadUInt32();
+        if (stream.Length() - stream.Position() < length * 2 + 24 + 16)
+            break;
+        QString path;
+        stream.ReadStringUnicode16(path, length);
+        FileHashEntry entry;
+        entry.status.size = stream.ReadInt64();
+        entry.status.modifiedNs = stream.ReadInt64();
+        entry.status.fileId = stream.ReadUInt64();
+        entry.md5 = QByteArray(16, 0);
+        stream.ReadToBuffer(reinterpret_cast<quint8 *>(entry.md5.data()), 16);
+        entry.stored = true;
+        g_entries.insert(path, entry);
+    }
+}
+
+static bool saveEntries()
+{
+    if (!g_dirty || g_cacheFile.length() == 0)
+        return true;
+
+    MemoryStream stream(12 + g_entries.count() * 128);
+    stream.WriteUInt32(FileHashCache::CacheTag);
+    stream.WriteUInt32(FileHashCache::CacheVersion);
+    stream.WriteUInt32(g_entries.count());
+    for (auto it = g_entries.constBegin(); it != g_entries.constEnd(); ++it)
+    {
+        stream.WriteUInt32(it.key().length());
+        stream.WriteStringUnicode16(it.key());
+        stream.WriteInt64(it.value().status.size);
+        stream.WriteInt64(it.value().status.modifiedNs);
+        stream.WriteUInt64(it.value().status.fileId);
+        stream.WriteFromBuffer(reinterpret_cast<quint8 *>(const_cast<char *>(it.value().md5.constData())), 16);
+    }
+
+    // QSaveFile writes to a temporary file and renames it over the old one
+    // on commit, so an interrupted run never leaves a truncated cache.
+    QSaveFile file(g_cacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        PERROR("Failed to write hash cache: " + g_cacheFile + "\n");
+        return false;
+    }
+    ByteBuffer buffer = stream.ToArray();
+    file.write(reinterpret_cast<const char *>(buffer.ptr()), buffer.size());
+    buffer.Free();
+    if (!file.commit())
+    {
+        PERROR("Failed to write hash cache: " + g_cacheFile + "\n");
+        return false;
+    }
+    g_dirty = false;
+    return true;
+}
+
+void FileHashCache::Open(const QString &cacheFile, const QString &rootPath)
+{
+    std::lock_guard<std::mutex> guard(g_lock);
+    if (g_cacheFile == cacheFile && g_rootPath == rootPath)
+        return;
+    saveEntries();
+    g_cacheFile = cacheFile;
+    g_rootPath = rootPath;
+    loadEntries();
+}
+
+bool FileHashCache::Lookup(const QString &filePath, QByteArray &md5)
+{
+    FileHashStatus status;
+    if (!getFileStatus(filePath, status))
+        return false;
+
+    std::lock_guard<std::mutex> guard(g_lock);
+    auto entry = g_entries.constFind(relativePath(filePath));
+    if (entry == g_entries.constEnd())
+        return false;
+    if (g_ignoreStored && entry.value().stored)
+        return false;
+    if (!sameStatus(entry.value().status, status))
+        return false;
+    md5 = entry.value().md5;
+    return true;
+}
+
+bool FileHashCache::GetStatus(const QString &filePath, FileHashStatus &status)
+{
+    return getFileStatus(filePath, status);
+}
+
+void FileHashCache::Store(const QString &filePath, const QByteArray &md5,
+                          const FileHashStatus &status)
+{
+    FileHashEntry entry;
+    if (md5.size() != 16 || !getFileStatus(filePath, entry.status))
+        return;
+    if (!sameStatus(entry.status, status))
+        return;
+    entry.md5 = md5;
+    entry.stored = false;
+
+    std::lock_guard<std::mutex> guard(g_lock);
+    g_entries.insert(relativePath(filePath), entry);
+    g_dirty = true;
+}
+
+bool FileHashCache::Save()
+{
+    std::lock_guard<std::mutex> guard(g_lock);
+    return saveEntries();
+}
+
+void FileHashCache::SetIgnoreStored(bool ignore)
+{
+    std::lock_guard<std::mutex> guard(g_lock);
+    g_ignoreStored = ignore;
+}
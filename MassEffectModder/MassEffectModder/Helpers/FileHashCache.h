@@ -0,0 +1,58 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef FILE_HASH_CACHE_H
+#define FILE_HASH_CACHE_H
+
+struct FileHashStatus
+{
+    qint64 size;
+    qint64 modifiedNs;
+    quint64 fileId;
+};
+
+// Persistent cache of file MD5 hashes, stored per game in the MEM config
+// directory. Entries are keyed by path relative to the game root and are
+// valid only while size, modification time and file id did not change.
+class FileHashCache
+{
+public:
+
+    enum
+    {
+        CacheTag = 0x48534D4D, // "MMSH"
+        CacheVersion = 1,
+    };
+
+    static void Open(const QString &cacheFile, const QString &rootPath);
+    static bool Lookup(const QString &filePath, QByteArray &md5);
+    // Status must be taken before hashing, the hash is not stored when
+    // the file changed while it was read.
+    static bool GetStatus(const QString &filePath, FileHashStatus &status);
+    static void Store(const QString &filePath, const QByteArray &md5,
+                      const FileHashStatus &status);
+    static bool Save();
+    // Hashes stored by previous runs are not trusted, every file is hashed
+    // again and the cache is refreshed with the new results.
+    static void SetIgnoreStored(bool ignore);
+};
+
+#endif
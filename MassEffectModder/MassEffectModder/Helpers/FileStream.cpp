@@ -30,8 +30,9 @@ void FileStream::CheckFileIOErrorStatus()
     }
 }
 
-FileStream::FileStream(const QString &path, FileMode mode, FileAccess access)
-    : file(nullptr)
+FileStream::FileStream(const QString &path, FileMode mode, FileAccess access, qint64 ioBufferSize)
+    : file(nullptr), buffer(nullptr), bufferSize(ioBufferSize), bufferStart(0),
+      bufferLength(0), bufferPosition(0), bufferMode(NoBuffer)
 {
     QFile::OpenMode openFlags = QIODevice::NotOpen;
     file = new QFile(path);
@@ -54,6 +55,9 @@ FileStream::FileStream(const QString &path, FileMode mode, FileAccess access)
             openFlags |= QIODevice::ReadWrite;
         break;
     }
+    // own buffer replaces the one in QIODevice
+    if (bufferSize > 0)
+        openFlags |= QIODevice::Unbuffered;
 
     if (!file->open(openFlags))
     {
@@ -66,25 +70,70 @@ FileStream::~FileStream()
 {
     Close();
     delete file;
+    delete[] buffer;
+}
+
+void FileStream::FlushWriteBuffer()
+{
+    if (bufferMode != WriteBuffer)
+        return;
+
+    bufferMode = NoBuffer;
+    if (bufferLength != 0)
+    {
+        file->write(reinterpret_cast<char *>(buffer), bufferLength);
+        bufferLength = 0;
+        CheckFileIOErrorStatus();
+    }
+}
+
+void FileStream::DropReadBuffer()
+{
+    if (bufferMode != ReadBuffer)
+        return;
+
+    bufferMode = NoBuffer;
+    qint64 position = bufferStart + bufferPosition;
+    if (position != file->pos())
+    {
+        file->seek(position);
+        CheckFileIOErrorStatus();
+    }
 }
 
 qint64 FileStream::Length()
 {
+    if (bufferMode == WriteBuffer)
+        return qMax(file->size(), bufferStart + bufferLength);
     return file->size();
 }
 
 qint64 FileStream::Position()
 {
+    switch (bufferMode)
+    {
+    case ReadBuffer:
+        return bufferStart + bufferPosition;
+    case WriteBuffer:
+        return bufferStart + bufferLength;
+    case NoBuffer:
+        break;
+    }
     return file->pos();
 }
 
 void FileStream::Flush()
 {
+    FlushWriteBuffer();
     file->flush();
 }
 
 void FileStream::Close()
 {
+    if (!file->isOpen())
+        return;
+    FlushWriteBuffer();
+    bufferMode = NoBuffer;
     file->close();
 }
 
@@ -108,8 +157,41 @@ void FileStream::CopyFrom(Stream &stream, qint64 count, qint64 bufferSize)
 
 void FileStream::ReadToBuffer(quint8 *buffer, qint64 count)
 {
-    file->read(reinterpret_cast<char *>(buffer), count);
+    FlushWriteBuffer();
+
+    if (bufferMode == ReadBuffer)
+    {
+        qint64 available = bufferLength - bufferPosition;
+        if (count <= available)
+        {
+            memcpy(buffer, this->buffer + bufferPosition, static_cast<size_t>(count));
+            bufferPosition += count;
+            return;
+        }
+        // take the rest of buffered data, file position is already past it
+        memcpy(buffer, this->buffer + bufferPosition, static_cast<size_t>(available));
+        bufferPosition = bufferLength;
+        buffer += available;
+        count -= available;
+        bufferMode = NoBuffer;
+    }
+
+    // big reads go directly to the destination
+    if (count >= bufferSize)
+    {
+        file->read(reinterpret_cast<char *>(buffer), count);
+        CheckFileIOErrorStatus();
+        return;
+    }
+
+    if (this->buffer == nullptr)
+        this->buffer = new quint8[static_cast<size_t>(bufferSize)];
+    bufferStart = file->pos();
+    bufferLength = qMax<qint64>(file->read(reinterpret_cast<char *>(this->buffer), bufferSize), 0);
     CheckFileIOErrorStatus();
+    bufferPosition = qMin(count, bufferLength);
+    bufferMode = ReadBuffer;
+    memcpy(buffer, this->buffer, static_cast<size_t>(bufferPosition));
 }
 
 ByteBuffer FileStream::ReadToBuffer(qint64 count)
@@ -127,8 +209,29 @@ ByteBuffer FileStream::ReadAllToBuffer()
 
 void FileStream::WriteFromBuffer(quint8 *buffer, qint64 count)
 {
-    file->write(reinterpret_cast<char *>(buffer), count);
-    CheckFileIOErrorStatus();
+    DropReadBuffer();
+
+    if (bufferMode == WriteBuffer && bufferLength + count > bufferSize)
+        FlushWriteBuffer();
+
+    // big writes go directly to the file
+    if (count >= bufferSize)
+    {
+        file->write(reinterpret_cast<char *>(buffer), count);
+        CheckFileIOErrorStatus();
+        return;
+    }
+
+    if (bufferMode != WriteBuffer)
+    {
+        if (this->buffer == nullptr)
+            this->buffer = new quint8[static_cast<size_t>(bufferSize)];
+        bufferStart = file->pos();
+        bufferLength = 0;
+        bufferMode = WriteBuffer;
+    }
+    memcpy(this->buffer + bufferLength, buffer, static_cast<size_t>(count));
+    bufferLength += count;
 }
 
 void FileStream::WriteFromBuffer(const ByteBuffer &buffer)
@@ -141,8 +244,7 @@ void FileStream::ReadStringASCII(QString &str, qint64 count)
     std::unique_ptr<char[]> buffer (new char[static_cast<size_t>(count) + 1]);
 
     buffer.get()[count] = 0;
-    file->read(buffer.get(), count);
-    CheckFileIOErrorStatus();
+    ReadToBuffer(reinterpret_cast<quint8 *>(buffer.get()), count);
     str = QString(buffer.get());
 }
 
@@ -151,12 +253,14 @@ void FileStream::ReadStringASCIINull(QString &str)
     str = "";
     do
     {
-        char c = 0;
-        file->getChar(&c);
-        CheckFileIOErrorStatus();
+        quint8 c = 0;
+        if (bufferMode == ReadBuffer && bufferPosition < bufferLength)
+            c = buffer[bufferPosition++];
+        else
+            ReadToBuffer(&c, sizeof(quint8));
         if (c == 0)
             return;
-        str += c;
+        str += static_cast<char>(c);
     } while (true);
 }
 
@@ -166,7 +270,6 @@ void FileStream::ReadStringUnicode16(QString &str, qint64 count)
     for (qint64 n = 0; n < count; n++)
     {
         quint16 c = ReadUInt16();
-        CheckFileIOErrorStatus();
         str += QChar(static_cast<ushort>(c));
     }
 }
@@ -177,7 +280,6 @@ void FileStream::ReadStringUnicode16Null(QString &str)
     do
     {
         quint16 c = ReadUInt16();
-        CheckFileIOErrorStatus();
         if (c == 0)
             return;
         str += QChar(static_cast<ushort>(c));
@@ -187,9 +289,8 @@ void FileStream::ReadStringUnicode16Null(QString &str)
 void FileStream::WriteStringASCII(const QString &str)
 {
     std::string string = str.toStdString();
-    const char *s = string.c_str();
-    file->write(s, string.length());
-    CheckFileIOErrorStatus();
+    auto s = const_cast<char *>(string.c_str());
+    WriteFromBuffer(reinterpret_cast<quint8 *>(s), string.length());
 }
 
 void FileStream::WriteStringASCIINull(const QString &str)
@@ -201,8 +302,7 @@ void FileStream::WriteStringASCIINull(const QString &str)
 void FileStream::WriteStringUnicode16(const QString &str)
 {
     auto *s = const_cast<ushort *>(str.utf16());
-    file->write(reinterpret_cast<char *>(s), str.length() * 2);
-    CheckFileIOErrorStatus();
+    WriteFromBuffer(reinterpret_cast<quint8 *>(s), str.length() * 2);
 }
 
 void FileStream::WriteStringUnicode16Null(const QString &str)
@@ -211,132 +311,45 @@ void FileStream::WriteStringUnicode16Null(const QString &str)
     WriteUInt16(0);
 }
 
-qint64 FileStream::ReadInt64()
-{
-    qint64 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(qint64));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-quint64 FileStream::ReadUInt64()
-{
-    quint64 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(quint64));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-qint32 FileStream::ReadInt32()
-{
-    qint32 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(qint32));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-quint32 FileStream::ReadUInt32()
-{
-    quint32 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(quint32));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-qint16 FileStream::ReadInt16()
-{
-    qint16 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(qint16));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-quint16 FileStream::ReadUInt16()
-{
-    quint16 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(quint16));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-quint8 FileStream::ReadByte()
-{
-    quint8 value;
-    file->read(reinterpret_cast<char *>(&value), sizeof(quint8));
-    CheckFileIOErrorStatus();
-    return value;
-}
-
-void FileStream::WriteInt64(qint64 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(qint64));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteUInt64(quint64 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(quint64));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteInt32(qint32 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(qint32));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteUInt32(quint32 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(quint32));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteInt16(qint16 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(qint16));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteUInt16(quint16 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(qint16));
-    CheckFileIOErrorStatus();
-}
-
-void FileStream::WriteByte(quint8 value)
-{
-    file->write(reinterpret_cast<char *>(&value), sizeof(quint8));
-    CheckFileIOErrorStatus();
-}
-
 void FileStream::WriteZeros(qint64 count)
 {
-    quint8 z = 0;
+    quint8 zeros[1024] = {};
 
-    for (qint64 l = 0; l < count; l++)
+    while (count > 0)
     {
-         file->write(reinterpret_cast<char *>(&z), sizeof(quint8));
-         CheckFileIOErrorStatus();
+        qint64 size = qMin(count, static_cast<qint64>(sizeof(zeros)));
+        WriteFromBuffer(zeros, size);
+        count -= size;
     }
 }
 
 void FileStream::Seek(qint64 offset, SeekOrigin origin)
 {
+    qint64 position = 0;
     switch (origin)
     {
     case SeekOrigin::Begin:
-        file->seek(offset);
-        CheckFileIOErrorStatus();
+        position = offset;
         break;
     case SeekOrigin::Current:
-        file->seek(file->pos() + offset);
-        CheckFileIOErrorStatus();
+        position = Position() + offset;
         break;
     case SeekOrigin::End:
-        file->seek(file->size() + offset);
-        CheckFileIOErrorStatus();
+        position = Length() + offset;
         break;
     }
+
+    // stay in read buffer if possible
+    if (bufferMode == ReadBuffer && position >= bufferStart && position <= bufferStart + bufferLength)
+    {
+        bufferPosition = position - bufferStart;
+        return;
+    }
+
+    FlushWriteBuffer();
+    bufferMode = NoBuffer;
+    file->seek(position);
+    CheckFileIOErrorStatus();
 }
 
 void FileStream::SeekBegin()
@@ -39,19 +39,75 @@ typedef enum
 
 class QFile;
 
-class FileStream : public Stream
+// Reads and writes go through a user space buffer, so parsing headers
+// and tables value by value does not end up in one syscall per value.
+// The buffer holds either read ahead data or pending writes, never both.
+class FileStream final : public Stream
 {
+public:
+
+    enum BufferSize
+    {
+        DefaultBufferSize = 0x10000, // 64KB
+    };
+
 private:
 
+    enum BufferMode
+    {
+        NoBuffer,
+        ReadBuffer,
+        WriteBuffer,
+    };
+
     QFile *file;
+    quint8 *buffer;
+    qint64 bufferSize;
+    qint64 bufferStart;    // file offset of first byte in buffer
+    qint64 bufferLength;   // bytes read ahead or pending to write
+    qint64 bufferPosition; // read position in buffer
+    BufferMode bufferMode;
 
     void CheckFileIOErrorStatus();
+    void FlushWriteBuffer();
+    void DropReadBuffer();
+
+    template <typename T>
+    T ReadValue()
+    {
+        T value;
+        if (bufferMode == ReadBuffer && bufferPosition + static_cast<qint64>(sizeof(T)) <= bufferLength)
+        {
+            memcpy(&value, buffer + bufferPosition, sizeof(T));
+            bufferPosition += sizeof(T);
+        }
+        else
+        {
+            ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(T));
+        }
+        return value;
+    }
+
+    template <typename T>
+    void WriteValue(T value)
+    {
+        if (bufferMode == WriteBuffer && bufferLength + static_cast<qint64>(sizeof(T)) <= bufferSize)
+        {
+            memcpy(buffer + bufferLength, &value, sizeof(T));
+            bufferLength += sizeof(T);
+        }
+        else
+        {
+            WriteFromBuffer(reinterpret_cast<quint8 *>(&value), sizeof(T));
+        }
+    }
 
 public:
 
     FileStream(const QString &path, FileMode mode)
       : FileStream(path, mode, FileAccess::ReadWrite) {}
-    FileStream(const QString &path, FileMode mode, FileAccess access);
+    FileStream(const QString &path, FileMode mode, FileAccess access,
+               qint64 ioBufferSize = DefaultBufferSize);
     ~FileStream() override;
 
     qint64 Length() override;
@@ -75,20 +131,20 @@ public:
     void WriteStringASCIINull(const QString &str) override;
     void WriteStringUnicode16(const QString &str) override;
     void WriteStringUnicode16Null(const QString &str) override;
-    qint64 ReadInt64() override;
-    quint64 ReadUInt64() override;
-    qint32 ReadInt32() override;
-    quint32 ReadUInt32() override;
-    qint16 ReadInt16() override;
-    quint16 ReadUInt16() override;
-    quint8 ReadByte() override;
-    void WriteInt64(qint64 value) override;
-    void WriteUInt64(quint64 value) override;
-    void WriteInt32(qint32 value) override;
-    void WriteUInt32(quint32 value) override;
-    void WriteInt16(qint16 value) override;
-    void WriteUInt16(quint16 value) override;
-    void WriteByte(quint8 value) override;
+    qint64 ReadInt64() override { return ReadValue<qint64>(); }
+    quint64 ReadUInt64() override { return ReadValue<quint64>(); }
+    qint32 ReadInt32() override { return ReadValue<qint32>(); }
+    quint32 ReadUInt32() override { return ReadValue<quint32>(); }
+    qint16 ReadInt16() override { return ReadValue<qint16>(); }
+    quint16 ReadUInt16() override { return ReadValue<quint16>(); }
+    quint8 ReadByte() override { return ReadValue<quint8>(); }
+    void WriteInt64(qint64 value) override { WriteValue<qint64>(value); }
+    void WriteUInt64(quint64 value) override { WriteValue<quint64>(value); }
+    void WriteInt32(qint32 value) override { WriteValue<qint32>(value); }
+    void WriteUInt32(quint32 value) override { WriteValue<quint32>(value); }
+    void WriteInt16(qint16 value) override { WriteValue<qint16>(value); }
+    void WriteUInt16(quint16 value) override { WriteValue<quint16>(value); }
+    void WriteByte(quint8 value) override { WriteValue<quint8>(value); }
     void WriteZeros(qint64 count) override;
     void Seek(qint64 offset, SeekOrigin origin) override;
     void SeekBegin() override;
@@ -0,0 +1,92 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "FileStreamPool.h"
+
+FileStreamPool::FileStreamPool(int idlePerThread, int idleTotal) :
+    maxIdlePerThread(qMax(1, idlePerThread)), maxIdle(qMax(1, idleTotal))
+{
+}
+
+FileStreamPool::~FileStreamPool()
+{
+    Clear();
+}
+
+FileStream *FileStreamPool::Acquire(const QString &path)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = idleStreams.count() - 1; i >= 0; i--)
+        {
+            if (idleStreams[i].path == path)
+                return idleStreams.takeAt(i).stream;
+        }
+    }
+
+    return new FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+}
+
+void FileStreamPool::Release(const QString &path, FileStream *stream)
+{
+    if (stream == nullptr)
+        return;
+
+    QList<FileStream *> evicted;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::thread::id owner = std::this_thread::get_id();
+        idleStreams.append(IdleStream{ path, stream, owner });
+
+        int ownedCount = 0;
+        for (int i = 0; i < idleStreams.count(); i++)
+        {
+            if (idleStreams[i].owner == owner)
+                ownedCount++;
+        }
+        for (int i = 0; i < idleStreams.count() && ownedCount > maxIdlePerThread; )
+        {
+            if (idleStreams[i].owner == owner)
+            {
+                evicted.append(idleStreams.takeAt(i).stream);
+                ownedCount--;
+            }
+            else
+            {
+                i++;
+            }
+        }
+        while (idleStreams.count() > maxIdle)
+            evicted.append(idleStreams.takeFirst().stream);
+    }
+
+    // closing does not need the lock
+    foreach(FileStream *evictedStream, evicted)
+        delete evictedStream;
+}
+
+void FileStreamPool::Clear()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    foreach(const IdleStream &idle, idleStreams)
+        delete idle.stream;
+    idleStreams.clear();
+}
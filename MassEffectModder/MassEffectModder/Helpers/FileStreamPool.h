@@ -0,0 +1,69 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef FILESTREAM_POOL_H
+#define FILESTREAM_POOL_H
+
+#include <Helpers/FileStream.h>
+
+// Keeps read-only file handles open between lookups, so many readers
+// (e.g. texture mipmaps stored in the same TFC) do not reopen the file
+// for each read. Each acquired handle is owned exclusively by the caller
+// until released, the pool itself can be shared between threads.
+// Idle handles are limited per releasing thread and in total,
+// least recently used ones are closed first.
+class FileStreamPool
+{
+public:
+
+    enum Limits
+    {
+        DefaultMaxIdlePerThread = 8,
+        DefaultMaxIdle = 64,
+    };
+
+private:
+
+    struct IdleStream
+    {
+        QString path;
+        FileStream *stream;
+        std::thread::id owner;
+    };
+
+    std::mutex lock;
+    QList<IdleStream> idleStreams; // least recently used first
+    int maxIdlePerThread;
+    int maxIdle;
+
+public:
+
+    FileStreamPool(int idlePerThread = DefaultMaxIdlePerThread, int idleTotal = DefaultMaxIdle);
+    FileStreamPool(const FileStreamPool &) = delete;
+    FileStreamPool &operator=(const FileStreamPool &) = delete;
+    ~FileStreamPool();
+
+    FileStream *Acquire(const QString &path);
+    void Release(const QString &path, FileStream *stream);
+    void Clear();
+};
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "IoPolicy.h"
+#include <Helpers/TaskScheduler.h>
+
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+static IoPolicy::StorageClass g_class = IoPolicy::UnknownStorage;
+static int g_queueDepth = 0;
+static QString g_detectedPath;
+static std::atomic<qint64> g_bandwidthLimit(0);
+static std::mutex g_throttleLock;
+static QElapsedTimer g_throttleTimer;
+static qint64 g_throttleNextNs = 0;
+
+#if defined(__linux__)
+static QString ReadSysfsValue(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString(file.readAll()).trimmed();
+}
+#endif
+
+void IoPolicy::Detect(const QString &path)
+{
+    if (path == g_detectedPath)
+        return;
+    g_detectedPath = path;
+    g_class = UnknownStorage;
+    g_queueDepth = 0;
+
+#if defined(__linux__)
+    struct stat st{};
+    if (stat(path.toUtf8().constData(), &st) != 0)
+        return;
+
+    // Partitions have own node without queue, it is in parent device directory.
+    QString device = QFileInfo(QString("/sys/dev/block/%1:%2")
+                               .arg(major(st.st_dev)).arg(minor(st.st_dev))).canonicalFilePath();
+    if (device.isEmpty())
+        return;
+    if (QFile(device + "/partition").exists())
+        device = QFileInfo(device + "/..").canonicalFilePath();
+
+    QString rotational = ReadSysfsValue(device + "/queue/rotational");
+    g_queueDepth = ReadSysfsValue(device + "/queue/nr_requests").toInt();
+    if (rotational == "1")
+        g_class = Rotational;
+    else if (QFileInfo(device).fileName().startsWith("nvme"))
+        g_class = NVMe;
+    else if (rotational == "0")
+        g_class = SolidState;
+#endif
+}
+
+IoPolicy::StorageClass IoPolicy::Class()
+{
+    return g_class;
+}
+
+const char *IoPolicy::ClassName()
+{
+    switch (g_class)
+    {
+    case Rotational:
+        return "rotational";
+    case SolidState:
+        return "solid state";
+    case NVMe:
+        return "NVMe";
+    case UnknownStorage:
+        break;
+    }
+    return "unknown";
+}
+
+int IoPolicy::QueueDepth()
+{
+    return g_queueDepth;
+}
+
+// Readers do also CPU work on the data, so never more than scheduler threads.
+int IoPolicy::ReadThreads()
+{
+    int threads = TaskScheduler::Threads();
+    switch (g_class)
+    {
+    case Rotational:
+        return qMin(threads, 2);
+    case SolidState:
+        return qMin(threads, 4);
+    case NVMe:
+        if (g_queueDepth > 0)
+            return qMax(1, qMin(threads, g_queueDepth));
+        return threads;
+    case UnknownStorage:
+        break;
+    }
+    return threads;
+}
+
+int IoPolicy::ReadChunkSize()
+{
+    switch (g_class)
+    {
+    case Rotational:
+        return 4 * 1024 * 1024;
+    case NVMe:
+        return 512 * 1024;
+    case SolidState:
+    case UnknownStorage:
+        break;
+    }
+    return 1024 * 1024;
+}
+
+// Number of files serial readers hint to the OS ahead of the current one,
+// on rotational disks read ahead of other files only adds seeks.
+int IoPolicy::PrefetchDepth()
+{
+    switch (g_class)
+    {
+    case Rotational:
+        return 0;
+    case SolidState:
+        return 2;
+    case NVMe:
+        return 4;
+    case UnknownStorage:
+        break;
+    }
+    return 1;
+}
+
+void IoPolicy::Prefetch(const QString &filePath)
+{
+#if defined(__linux__)
+    int fd = open(filePath.toUtf8().constData(), O_RDONLY);
+    if (fd < 0)
+        return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#else
+    Q_UNUSED(filePath);
+#endif
+}
+
+void IoPolicy::SetBandwidthLimit(qint64 bytesPerSecond)
+{
+    std::lock_guard<std::mutex> guard(g_throttleLock);
+    g_bandwidthLimit = bytesPerSecond > 0 ? bytesPerSecond : 0;
+    g_throttleTimer.start();
+    g_throttleNextNs = 0;
+}
+
+qint64 IoPolicy::BandwidthLimit()
+{
+    return g_bandwidthLimit;
+}
+
+// Every read reserves its time slot at the limited rate,
+// caller waits until the slot starts.
+void IoPolicy::Throttle(qint64 bytes)
+{
+    qint64 limit = g_bandwidthLimit;
+    if (limit == 0 || bytes <= 0)
+        return;
+
+    qint64 waitNs;
+    {
+        std::lock_guard<std::mutex> guard(g_throttleLock);
+        qint64 now = g_throttleTimer.nsecsElapsed();
+        if (g_throttleNextNs < now)
+            g_throttleNextNs = now;
+        waitNs = g_throttleNextNs - now;
+        g_throttleNextNs += static_cast<qint64>(bytes * 1000000000.0 / limit);
+    }
+    if (waitNs > 0)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+}
+
+void IoPolicy::ThrottleFile(const QString &filePath)
+{
+    if (g_bandwidthLimit == 0)
+        return;
+    Throttle(QFileInfo(filePath).size());
+}
@@ -0,0 +1,55 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef IO_POLICY_H
+#define IO_POLICY_H
+
+// Read concurrency and request sizes matched to storage holding game data.
+// Rotational disks get few large sequential reads, solid state drives more
+// parallel readers and read ahead. Optional bandwidth cap keeps background
+// installs from starving the rest of the machine.
+class IoPolicy
+{
+public:
+
+    enum StorageClass
+    {
+        UnknownStorage,
+        Rotational,
+        SolidState,
+        NVMe
+    };
+
+    static void Detect(const QString &path);
+    static StorageClass Class();
+    static const char *ClassName();
+    static int QueueDepth();
+    static int ReadThreads();
+    static int ReadChunkSize();
+    static int PrefetchDepth();
+    static void Prefetch(const QString &filePath);
+    static void SetBandwidthLimit(qint64 bytesPerSecond);
+    static qint64 BandwidthLimit();
+    static void Throttle(qint64 bytes);
+    static void ThrottleFile(const QString &filePath);
+};
+
+#endif
@@ -21,6 +21,122 @@
 
 #include "Logs.h"
 
+AsyncLogWriter::AsyncLogWriter(FILE *logFile) :
+        slots(new Slot[QueueSize]),
+        enqueuePos(0),
+        dequeuePos(0),
+        stopRequested(false),
+        drained(false),
+        file(logFile)
+{
+    for (quint64 i = 0; i < QueueSize; i++)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    writerThread = std::thread(&AsyncLogWriter::WriterLoop, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    stopRequested = true;
+    wakeCondition.notify_one();
+    if (writerThread.joinable())
+        writerThread.join();
+    WritePending();
+    fclose(file);
+    delete[] slots;
+}
+
+void AsyncLogWriter::WriteMessage(const QString &message)
+{
+#if defined(_WIN32)
+    std::fputws(message.toStdWString().c_str(), file);
+#else
+    std::fputs(message.toStdString().c_str(), file);
+#endif
+}
+
+void AsyncLogWriter::WritePending()
+{
+    std::lock_guard<std::mutex> guard(consumerLock);
+    bool written = false;
+    for (;;)
+    {
+        Slot &slot = slots[dequeuePos & (QueueSize - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            break;
+        QString message = std::move(slot.message);
+        slot.message = QString();
+        slot.sequence.store(dequeuePos + QueueSize, std::memory_order_release);
+        dequeuePos++;
+        WriteMessage(message);
+        written = true;
+    }
+    if (written)
+        fflush(file);
+}
+
+void AsyncLogWriter::WriterLoop()
+{
+    while (!stopRequested)
+    {
+        {
+            std::unique_lock<std::mutex> wait(wakeLock);
+            wakeCondition.wait_for(wait, std::chrono::milliseconds(FlushIntervalMs));
+        }
+        WritePending();
+    }
+}
+
+void AsyncLogWriter::Push(const QString &message)
+{
+    if (drained)
+    {
+        std::lock_guard<std::mutex> guard(consumerLock);
+        WriteMessage(message);
+        fflush(file);
+        return;
+    }
+
+    quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot &slot = slots[pos & (QueueSize - 1)];
+        quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<qint64>(sequence - pos);
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.message = message;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Queue is full, wake up writer and wait for free slot
+            wakeCondition.notify_one();
+            std::this_thread::yield();
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (((pos + 1) & (QueueSize / 2 - 1)) == 0)
+        wakeCondition.notify_one();
+}
+
+// Write out all queued messages from the calling thread and switch
+// to synchronous writes, used on crash and exit paths where
+// the writer thread may not get a chance to run anymore.
+void AsyncLogWriter::Drain()
+{
+    drained = true;
+    WritePending();
+}
+
 Logs::Logs() :
         startedTimestamp(0),
         logLevel(LOG_NONE),
@@ -33,6 +149,11 @@ Logs::Logs() :
     startedTimestamp = QDateTime::currentMSecsSinceEpoch();
 }
 
+Logs::~Logs()
+{
+    fileWriter.reset();
+}
+
 void Logs::ChangeLogLevel(LOG_LEVEL level)
 {
     logLevel = level;
@@ -55,6 +176,8 @@ void Logs::EnableOutputConsole(bool enable)
 
 void Logs::EnableOutputFile(const QString &path, bool enable)
 {
+    lock.lock();
+    std::atomic_store(&fileWriter, std::shared_ptr<AsyncLogWriter>());
     logPath = path;
 #if defined(_WIN32)
     FILE *file = _wfopen(logPath.toStdWString().c_str(), L"w");
@@ -62,8 +185,22 @@ void Logs::EnableOutputFile(const QString &path, bool enable)
     FILE *file = fopen(logPath.toStdString().c_str(), "w");
 #endif
     if (file)
-        fclose(file);
-    fileEnabled = enable;
+    {
+        if (enable)
+            std::atomic_store(&fileWriter, std::make_shared<AsyncLogWriter>(file));
+        else
+            fclose(file);
+    }
+    fileEnabled = enable && fileWriter != nullptr;
+    lock.unlock();
+}
+
+void Logs::Drain()
+{
+    // used on crash paths, so it does not wait for the lock
+    std::shared_ptr<AsyncLogWriter> writer = std::atomic_load(&fileWriter);
+    if (writer)
+        writer->Drain();
 }
 
 void Logs::EnableTimeStamp(bool enable)
@@ -101,30 +238,21 @@ void Logs::Print(int level, const QString &message, int flags)
 #endif
     }
 
+    std::shared_ptr<AsyncLogWriter> writer;
     if (fileEnabled && (flags & LOG_FILE))
-    {
-#if defined(_WIN32)
-        FILE *file = _wfopen(logPath.toStdWString().c_str(), L"a");
-#else
-        FILE *file = fopen(logPath.toStdString().c_str(), "a");
-#endif
-        if (file)
-        {
-#if defined(_WIN32)
-            std::fputws((timestampStr + message).toStdWString().c_str(), file);
-#else
-            std::fputs((timestampStr + message).toStdString().c_str(), file);
-#endif
-            fclose(file);
-        }
-    }
+        writer = fileWriter;
 
     lock.unlock();
+
+    // queue is lock-free, producers must not be serialized by the lock above
+    if (writer)
+        writer->Push(timestampStr + message);
 }
 
 void Logs::PrintCrash(const std::string &message)
 {
     Print(LOG_NONE, QString(message.c_str()), LOG_ALL_OUTPUTS);
+    Drain();
 }
 
 void Logs::PrintError(const QString &message)
@@ -35,6 +35,48 @@ enum LOG_LEVEL {
 #define LOG_ERROR_BUFFER  0x04
 #define LOG_ALL_OUTPUTS   (LOG_CONSOLE | LOG_FILE | LOG_ERROR_BUFFER)
 
+// Writes log file messages from a dedicated thread. Producers only push
+// messages into a bounded lock-free MPSC ring buffer, the writer thread keeps
+// the file open and flushes batches at least every FlushIntervalMs.
+class AsyncLogWriter
+{
+private:
+
+    enum
+    {
+        QueueSize = 4096, // must be power of 2
+        FlushIntervalMs = 100,
+    };
+
+    struct Slot
+    {
+        std::atomic<quint64> sequence;
+        QString message;
+    };
+
+    Slot                    *slots;
+    alignas(64) std::atomic<quint64> enqueuePos;
+    alignas(64) quint64     dequeuePos;
+    std::mutex              consumerLock;
+    std::mutex              wakeLock;
+    std::condition_variable wakeCondition;
+    std::atomic<bool>       stopRequested;
+    std::atomic<bool>       drained;
+    std::thread             writerThread;
+    FILE                    *file;
+
+    void WriterLoop();
+    void WritePending();
+    void WriteMessage(const QString &message);
+
+public:
+
+    explicit AsyncLogWriter(FILE *logFile);
+    ~AsyncLogWriter();
+    void Push(const QString &message);
+    void Drain();
+};
+
 class Logs
 {
 private:
@@ -49,12 +91,16 @@ private:
     bool            consoleEnabled;
     bool            fileEnabled;
     bool            errorBufferEnabled;
+    // shared, so producers writing outside the lock keep it alive
+    // while the output is reconfigured
+    std::shared_ptr<AsyncLogWriter> fileWriter;
 
     void Print(int level, const QString &message, int flags);
 
 public:
 
     Logs();
+    ~Logs();
     void PrintCrash(const std::string &message);
 
     void PrintInfo(const QString &message);
@@ -68,6 +114,7 @@ public:
     void EnableOutputConsole(bool enable);
     void EnableOutputFile(const QString &path, bool enable);
     void EnableTimeStamp(bool enable);
+    void Drain();
     QString GetLogPath() { return logPath; }
 };
 
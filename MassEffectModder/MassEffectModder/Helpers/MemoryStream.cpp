@@ -21,15 +21,21 @@
 
 #include "MemoryStream.h"
 
+std::atomic<qint64> MemoryStream::reallocCount{0};
+
 MemoryStream::MemoryStream()
+    : MemoryStream(static_cast<qint64>(initialBufferSize))
+{
+}
+
+MemoryStream::MemoryStream(qint64 capacity)
 {
-    internalBuffer = static_cast<quint8 *>(std::malloc(static_cast<size_t>(initialBufferSize)));
+    internalBuffer = static_cast<quint8 *>(std::malloc(static_cast<size_t>(capacity)));
     if (internalBuffer == nullptr)
     {
         CRASH_MSG("MemoryStream: out of memory.");
     }
-    memset(internalBuffer, 0, initialBufferSize);
-    internalBufferSize = initialBufferSize;
+    internalBufferSize = capacity;
     length = 0;
     position = 0;
 }
@@ -191,23 +197,43 @@ ByteBuffer MemoryStream::ReadToBuffer(qint64 count)
     return buffer;
 }
 
-void MemoryStream::WriteFromBuffer(quint8 *buffer, qint64 count)
+void MemoryStream::Reserve(qint64 capacity)
+{
+    if (capacity <= internalBufferSize)
+        return;
+
+    internalBuffer = static_cast<quint8 *>(std::realloc(internalBuffer, static_cast<size_t>(capacity)));
+    if (internalBuffer == nullptr)
+    {
+        CRASH_MSG("MemoryStream: out of memory.");
+    }
+    internalBufferSize = capacity;
+    reallocCount++;
+}
+
+quint8 *MemoryStream::PrepareWrite(qint64 count)
 {
     qint64 newPosition = position + count;
     if (newPosition > internalBufferSize)
     {
-        internalBufferSize = newPosition + internalBufferSize * 2;
-        internalBuffer = static_cast<quint8 *>(std::realloc(internalBuffer, static_cast<size_t>(internalBufferSize)));
-        if (internalBuffer == nullptr)
-        {
-            CRASH_MSG("MemoryStream: out of memory.");
-        }
-        memset(internalBuffer + length, 0, static_cast<size_t>(internalBufferSize - length));
+        // grow by half of the current capacity at least, keeps appends amortised O(1)
+        Reserve(qMax(newPosition, internalBufferSize + internalBufferSize / 2));
+    }
+    if (position > length)
+    {
+        // area skipped by seek past the end reads as zeros
+        memset(internalBuffer + length, 0, static_cast<size_t>(position - length));
     }
     if (newPosition > length)
         length = newPosition;
-    memcpy(internalBuffer + position, buffer, static_cast<size_t>(count));
-    position += count;
+    quint8 *ptr = internalBuffer + position;
+    position = newPosition;
+    return ptr;
+}
+
+void MemoryStream::WriteFromBuffer(quint8 *buffer, qint64 count)
+{
+    memcpy(PrepareWrite(count), buffer, static_cast<size_t>(count));
 }
 
 void MemoryStream::WriteFromBuffer(const ByteBuffer &buffer)
@@ -369,8 +395,7 @@ void MemoryStream::WriteByte(quint8 value)
 
 void MemoryStream::WriteZeros(qint64 count)
 {
-    for (qint64 l = 0; l < count; l++)
-         WriteByte(0);
+    memset(PrepareWrite(count), 0, static_cast<size_t>(count));
 }
 
 void MemoryStream::Seek(qint64 offset, SeekOrigin origin)
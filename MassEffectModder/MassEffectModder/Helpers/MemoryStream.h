@@ -39,9 +39,15 @@ private:
     quint8 *internalBuffer;
     qint64 internalBufferSize;
 
+    static std::atomic<qint64> reallocCount;
+
+    quint8 *PrepareWrite(qint64 count);
+
 public:
 
     MemoryStream();
+    // Empty stream with room for capacity bytes, for writers knowing the final size.
+    explicit MemoryStream(qint64 capacity);
     MemoryStream(const ByteBuffer &buffer);
     MemoryStream(const ByteBuffer &buffer, qint64 offset);
     MemoryStream(const ByteBuffer &buffer, qint64 offset, qint64 count);
@@ -56,6 +62,11 @@ public:
     void Flush() override {}
     void Close() override {}
     ByteBuffer ToArray();
+    qint64 Capacity() { return internalBufferSize; }
+    void Reserve(qint64 capacity);
+    // Process wide count of buffer reallocations, reported by metrics.
+    static qint64 ReallocCount() { return reallocCount; }
+    static void ResetReallocCount() { reallocCount = 0; }
 
     void CopyFrom(Stream &stream, qint64 count, qint64 bufferSize = 10000) override;
     void ReadToBuffer(quint8 *buffer, qint64 count) override;
@@ -0,0 +1,274 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Metrics.h"
+#include <Helpers/BufferPool.h>
+#include <Helpers/MemoryStream.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
+#include <Helpers/IoPolicy.h>
+#include <Helpers/TaskScheduler.h>
+
+#define PIXEL_FORMATS_COUNT (PixelFormat::G8 + 1)
+
+struct MetricsHistogram
+{
+    std::atomic<quint64> count;
+    std::atomic<quint64> sum;
+    std::atomic<quint64> min;
+    std::atomic<quint64> max;
+    std::atomic<quint64> buckets[Metrics::HistogramBuckets];
+};
+
+static std::atomic<qint64> g_counters[Metrics::CountersCount];
+static std::atomic<qint64> g_texturesEncoded[PIXEL_FORMATS_COUNT];
+static MetricsHistogram g_histograms[Metrics::HistogramsCount];
+
+static const char *pixelFormatNames[PIXEL_FORMATS_COUNT] =
+{
+    "Unknown", "DXT1", "DXT3", "DXT5", "ATI2", "V8U8", "ARGB", "RGB", "G8"
+};
+
+void Metrics::Add(Counter counter, qint64 value)
+{
+    g_counters[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+void Metrics::AddTextureEncoded(PixelFormat format)
+{
+    if (format >= 0 && format < PIXEL_FORMATS_COUNT)
+        g_texturesEncoded[format].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::Record(Histogram histogram, quint64 value)
+{
+    MetricsHistogram &h = g_histograms[histogram];
+    int bucket = 0;
+    while (bucket < HistogramBuckets - 1 && (value >> (bucket + 1)) != 0)
+        bucket++;
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.sum.fetch_add(value, std::memory_order_relaxed);
+    if (h.count.fetch_add(1, std::memory_order_relaxed) == 0)
+        h.min.store(value, std::memory_order_relaxed);
+
+    quint64 current = h.min.load(std::memory_order_relaxed);
+    while (value < current && !h.min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    current = h.max.load(std::memory_order_relaxed);
+    while (value > current && !h.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void Metrics::Reset()
+{
+    MemoryStream::ResetReallocCount();
+    BufferPool::ResetStats();
+    TaskScheduler::ResetStats();
+    for (auto &counter : g_counters)
+        counter = 0;
+    for (auto &counter : g_texturesEncoded)
+        counter = 0;
+    for (auto &h : g_histograms)
+    {
+        h.count = 0;
+        h.sum = 0;
+        h.min = 0;
+        h.max = 0;
+        for (auto &bucket : h.buckets)
+            bucket = 0;
+    }
+}
+
+// Returns upper bound of bucket holding given percentile.
+static quint64 HistogramPercentile(const MetricsHistogram &h, int percentile)
+{
+    quint64 count = h.count.load(std::memory_order_relaxed);
+    if (count == 0)
+        return 0;
+    quint64 threshold = (count * percentile + 99) / 100;
+    quint64 accumulated = 0;
+    for (int b = 0; b < Metrics::HistogramBuckets; b++)
+    {
+        accumulated += h.buckets[b].load(std::memory_order_relaxed);
+        if (accumulated >= threshold)
+            return qMin((2ULL << b) - 1, h.max.load(std::memory_order_relaxed));
+    }
+    return h.max.load(std::memory_order_relaxed);
+}
+
+static QString FormatMB(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+static QString FormatMs(quint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 1) + " ms";
+}
+
+static double ChunkCacheHitRate()
+{
+    qint64 hits = g_counters[Metrics::ChunkCacheHits];
+    qint64 lookups = hits + g_counters[Metrics::ChunkCacheMisses];
+    if (lookups == 0)
+        return 0;
+    return static_cast<double>(hits) / lookups;
+}
+
+QString Metrics::Summary()
+{
+    QString summary = "Metrics summary:\n";
+    summary += "  Decompressed: zlib " + FormatMB(g_counters[BytesDecompressedZlib]) +
+               ", lzo " + FormatMB(g_counters[BytesDecompressedLzo]) +
+               ", zstd " + FormatMB(g_counters[BytesDecompressedZstd]) + "\n";
+    summary += "  Compressed: zlib " + FormatMB(g_counters[BytesCompressedZlib]) +
+               ", lzo " + FormatMB(g_counters[BytesCompressedLzo]) +
+               ", zstd " + FormatMB(g_counters[BytesCompressedZstd]) + "\n";
+    summary += "  Chunks decoded: " + QString::number(g_counters[ChunksDecoded]) +
+               ", chunk cache hit rate: " + QString::number(ChunkCacheHitRate() * 100, 'f', 1) + "%\n";
+    summary += "  TFC appended: " + FormatMB(g_counters[TfcBytesAppended]) + "\n";
+    BufferPool::Stats pool = BufferPool::GetStats();
+    summary += "  Buffer pool: hits " + QString::number(pool.hits) +
+               ", misses " + QString::number(pool.misses) +
+               ", discards " + QString::number(pool.discards) +
+               ", peak retained " + FormatMB(pool.peakBytesRetained) + "\n";
+
+    QString encoded;
+    for (int f = 0; f < PIXEL_FORMATS_COUNT; f++)
+    {
+        if (g_texturesEncoded[f] == 0)
+            continue;
+        if (encoded.length() != 0)
+            encoded += ", ";
+        encoded += QString(pixelFormatNames[f]) + " " + QString::number(g_texturesEncoded[f]);
+    }
+    summary += "  Textures encoded: " + (encoded.length() != 0 ? encoded : "none") + "\n";
+
+    const MetricsHistogram &h = g_histograms[PackageTime];
+    quint64 count = h.count;
+    if (count != 0)
+    {
+        summary += "  Time per package: count " + QString::number(count) +
+                   ", avg " + FormatMs(h.sum / count) +
+                   ", min " + FormatMs(h.min) +
+                   ", max " + FormatMs(h.max) +
+                   ", p50 " + FormatMs(HistogramPercentile(h, 50)) +
+                   ", p90 " + FormatMs(HistogramPercentile(h, 90)) + "\n";
+    }
+    summary += TaskScheduler::Summary();
+    summary += QString("  Storage: ") + IoPolicy::ClassName() +
+               ", queue depth " + QString::number(IoPolicy::QueueDepth()) +
+               ", read threads " + QString::number(IoPolicy::ReadThreads()) + "\n";
+    summary += "  Peak memory usage: " + FormatMB(DetectPeakMemoryUsage()) + "\n";
+
+    return summary;
+}
+
+QString Metrics::SummaryJson()
+{
+    QJsonObject decompressed;
+    decompressed["zlib"] = g_counters[BytesDecompressedZlib].load();
+    decompressed["lzo"] = g_counters[BytesDecompressedLzo].load();
+    decompressed["zstd"] = g_counters[BytesDecompressedZstd].load();
+    QJsonObject compressed;
+    compressed["zlib"] = g_counters[BytesCompressedZlib].load();
+    compressed["lzo"] = g_counters[BytesCompressedLzo].load();
+    compressed["zstd"] = g_counters[BytesCompressedZstd].load();
+    QJsonObject encoded;
+    for (int f = 0; f < PIXEL_FORMATS_COUNT; f++)
+    {
+        if (g_texturesEncoded[f] != 0)
+            encoded[pixelFormatNames[f]] = g_texturesEncoded[f].load();
+    }
+    const MetricsHistogram &h = g_histograms[PackageTime];
+    QJsonObject packageTime;
+    packageTime["count"] = static_cast<qint64>(h.count.load());
+    packageTime["sumUs"] = static_cast<qint64>(h.sum.load());
+    packageTime["minUs"] = static_cast<qint64>(h.min.load());
+    packageTime["maxUs"] = static_cast<qint64>(h.max.load());
+    packageTime["p50Us"] = static_cast<qint64>(HistogramPercentile(h, 50));
+    packageTime["p90Us"] = static_cast<qint64>(HistogramPercentile(h, 90));
+
+    BufferPool::Stats pool = BufferPool::GetStats();
+    QJsonObject bufferPool;
+    bufferPool["hits"] = static_cast<qint64>(pool.hits);
+    bufferPool["misses"] = static_cast<qint64>(pool.misses);
+    bufferPool["releases"] = static_cast<qint64>(pool.releases);
+    bufferPool["discards"] = static_cast<qint64>(pool.discards);
+    bufferPool["bytesRetained"] = static_cast<qint64>(pool.bytesRetained);
+    bufferPool["peakBytesRetained"] = static_cast<qint64>(pool.peakBytesRetained);
+
+    QJsonObject scheduler;
+    scheduler["threads"] = TaskScheduler::Threads();
+    for (int i = 0; i < TaskScheduler::StagesCount; i++)
+    {
+        auto stage = static_cast<TaskScheduler::Stage>(i);
+        TaskScheduler::StageStats stats = TaskScheduler::GetStats(stage);
+        if (stats.loops == 0)
+            continue;
+        QJsonObject stageStats;
+        stageStats["loops"] = static_cast<qint64>(stats.loops);
+        stageStats["serialLoops"] = static_cast<qint64>(stats.serialLoops);
+        stageStats["tasks"] = static_cast<qint64>(stats.tasks);
+        stageStats["queueDepth"] = static_cast<qint64>(stats.queueDepth);
+        stageStats["peakQueueDepth"] = static_cast<qint64>(stats.peakQueueDepth);
+        stageStats["utilisation"] = stats.utilisation;
+        scheduler[TaskScheduler::StageName(stage)] = stageStats;
+    }
+
+    QJsonObject storage;
+    storage["class"] = IoPolicy::ClassName();
+    storage["queueDepth"] = IoPolicy::QueueDepth();
+    storage["readThreads"] = IoPolicy::ReadThreads();
+    storage["bandwidthLimit"] = IoPolicy::BandwidthLimit();
+
+    QJsonObject metrics;
+    metrics["bytesDecompressed"] = decompressed;
+    metrics["bytesCompressed"] = compressed;
+    metrics["chunksDecoded"] = g_counters[ChunksDecoded].load();
+    metrics["chunkCacheHits"] = g_counters[ChunkCacheHits].load();
+    metrics["chunkCacheMisses"] = g_counters[ChunkCacheMisses].load();
+    metrics["chunkCacheHitRate"] = ChunkCacheHitRate();
+    metrics["tfcBytesAppended"] = g_counters[TfcBytesAppended].load();
+    metrics["memoryStreamReallocs"] = MemoryStream::ReallocCount();
+    metrics["bufferPool"] = bufferPool;
+    metrics["texturesEncoded"] = encoded;
+    metrics["packageTime"] = packageTime;
+    metrics["scheduler"] = scheduler;
+    metrics["storage"] = storage;
+    metrics["peakMemoryBytes"] = static_cast<qint64>(DetectPeakMemoryUsage());
+
+    return QString::fromUtf8(QJsonDocument(metrics).toJson(QJsonDocument::Compact));
+}
+
+void Metrics::PrintSummary()
+{
+    if (g_ipc)
+    {
+        ConsoleWrite("[IPC]METRICS " + SummaryJson());
+        ConsoleSync();
+    }
+    else
+    {
+        PINFO("\n" + Summary());
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Types/MemTypes.h>
+
+// Process wide counters and histograms, updated lock-free from any thread
+// and printed as summary at the end of command line commands.
+class Metrics
+{
+public:
+
+    enum Counter
+    {
+        BytesDecompressedZlib,
+        BytesDecompressedLzo,
+        BytesDecompressedZstd,
+        BytesCompressedZlib,
+        BytesCompressedLzo,
+        BytesCompressedZstd,
+        ChunksDecoded,
+        ChunkCacheHits,
+        ChunkCacheMisses,
+        TfcBytesAppended,
+        CountersCount
+    };
+
+    enum Histogram
+    {
+        PackageTime, // microseconds
+        HistogramsCount
+    };
+
+    enum
+    {
+        HistogramBuckets = 40, // log2 buckets
+    };
+
+    static void Add(Counter counter, qint64 value = 1);
+    static void AddTextureEncoded(PixelFormat format);
+    static void Record(Histogram histogram, quint64 value);
+    static void Reset();
+    static QString Summary();
+    static QString SummaryJson();
+    static void PrintSummary();
+};
+
+class MetricsTimer
+{
+private:
+
+    Metrics::Histogram histogram;
+    QElapsedTimer timer;
+
+public:
+
+    explicit MetricsTimer(Metrics::Histogram timerHistogram)
+        : histogram(timerHistogram)
+    {
+        timer.start();
+    }
+    MetricsTimer(const MetricsTimer &) = delete;
+    MetricsTimer &operator=(const MetricsTimer &) = delete;
+
+    ~MetricsTimer()
+    {
+        Metrics::Record(histogram, static_cast<quint64>(timer.nsecsElapsed() / 1000));
+    }
+};
+
+#endif
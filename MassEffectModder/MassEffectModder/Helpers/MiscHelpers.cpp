@@ -21,12 +21,17 @@
 
 #if defined(_WIN32)
 #include <windows.h>
+#include <psapi.h>
 #elif defined(__APPLE__)
 #include <sys/sysctl.h>
+#include <sys/resource.h>
 #include <unistd.h>
+#include <fcntl.h>
 #elif defined(__linux__)
 #include <sys/sysinfo.h>
+#include <sys/resource.h>
 #include <unistd.h>
+#include <fcntl.h>
 #else
 #error not supported system!
 #endif
@@ -56,6 +61,25 @@ int DetectAmountMemoryGB()
     return amountGB;
 }
 
+quint64 DetectPeakMemoryUsage()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return static_cast<quint64>(usage.ru_maxrss);
+#else
+    return static_cast<quint64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
 #define MAX_MSG_SIZE 4000
 
 void ConsoleWrite(const QString &message)
@@ -106,6 +130,42 @@ QString GetFileExtension(const QString &path)
     return str.mid(index + 1, -1);
 }
 
+// Reads last "count" bytes of file with single positioned read, without
+// going through QFile, used where only file tail is needed for many files.
+bool ReadFileTail(const QString &path, quint8 *buffer, int count)
+{
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(reinterpret_cast<LPCWSTR>(path.utf16()), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    bool status = false;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart >= count)
+    {
+        OVERLAPPED overlapped{};
+        ULONGLONG offset = size.QuadPart - count;
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD readed = 0;
+        status = ReadFile(handle, buffer, count, &readed, &overlapped) && readed == static_cast<DWORD>(count);
+    }
+    CloseHandle(handle);
+    return status;
+#else
+    int fd = ::open(path.toUtf8().constData(), O_RDONLY);
+    if (fd == -1)
+        return false;
+    bool status = false;
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size >= count)
+        status = ::pread(fd, buffer, count, size - count) == count;
+    ::close(fd);
+    return status;
+#endif
+}
+
 bool DetectAdminRights()
 {
     bool status;
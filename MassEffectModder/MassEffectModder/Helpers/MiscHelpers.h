@@ -25,12 +25,14 @@
 #include <Types/MemTypes.h>
 
 int DetectAmountMemoryGB();
+quint64 DetectPeakMemoryUsage();
 void ConsoleWrite(const QString &message);
 void ConsoleSync();
 QString BaseName(const QString &path);
 QString DirName(const QString &path);
 QString BaseNameWithoutExt(const QString &path);
 QString GetFileExtension(const QString &path);
+bool ReadFileTail(const QString &path, quint8 *buffer, int count);
 
 inline bool AsciiStringEndsWith(const QString &str, const char *endStr, int endStrLen)
 {
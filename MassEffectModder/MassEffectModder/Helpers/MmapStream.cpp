@@ -0,0 +1,126 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "MmapStream.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+MmapStream::MmapStream(const QString &path, AccessPattern pattern)
+    : mapped(false)
+{
+    file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        auto error = (QString("Error: ") + file->errorString() + "\nFailed to open file: " + path + "\n").toStdString();
+        CRASH_MSG(error.c_str());
+    }
+
+    length = file->size();
+    if (length == 0)
+        return;
+
+    data = file->map(0, length);
+    if (data != nullptr)
+    {
+        mapped = true;
+#if !defined(_WIN32)
+        switch (pattern)
+        {
+        case AccessPattern::Normal:
+            break;
+        case AccessPattern::Sequential:
+            Advise(0, length, MADV_SEQUENTIAL);
+            break;
+        case AccessPattern::Random:
+            Advise(0, length, MADV_RANDOM);
+            break;
+        }
+#else
+        Q_UNUSED(pattern);
+#endif
+        return;
+    }
+
+    // mapping is not available for this file, keep the content in memory instead
+    data = static_cast<quint8 *>(std::malloc(static_cast<size_t>(length)));
+    if (data == nullptr)
+    {
+        CRASH_MSG("MmapStream: out of memory.");
+    }
+    if (file->read(reinterpret_cast<char *>(data), length) != length)
+    {
+        auto error = (QString("Error: ") + file->errorString() + ", File: " + path).toStdString();
+        CRASH_MSG(error.c_str());
+    }
+}
+
+MmapStream::~MmapStream()
+{
+    Close();
+    delete file;
+}
+
+void MmapStream::Close()
+{
+    if (data != nullptr)
+    {
+        if (mapped)
+            file->unmap(data);
+        else
+            std::free(data);
+        data = nullptr;
+    }
+    mapped = false;
+    length = position = 0;
+    file->close();
+}
+
+void MmapStream::Advise(qint64 offset, qint64 count, int advice)
+{
+#if !defined(_WIN32)
+    if (!mapped || count <= 0)
+        return;
+    // madvise needs page aligned address, mapping itself starts at page boundary
+    auto pageSize = static_cast<qint64>(sysconf(_SC_PAGESIZE));
+    qint64 start = offset - (offset % pageSize);
+    qint64 end = qMin(offset + count, length);
+    if (start >= end)
+        return;
+    madvise(data + start, static_cast<size_t>(end - start), advice);
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(count);
+    Q_UNUSED(advice);
+#endif
+}
+
+void MmapStream::WillNeed(qint64 offset, qint64 count)
+{
+#if !defined(_WIN32)
+    Advise(offset, count, MADV_WILLNEED);
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(count);
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef MMAPSTREAM_H
+#define MMAPSTREAM_H
+
+#include "SpanStream.h"
+
+class QFile;
+
+// Read-only stream over a memory mapped file. Reads are served straight
+// from the page cache without syscalls, and Borrow() gives direct access
+// to the mapped bytes, so decompressors can read them without a copy.
+// If the file can not be mapped, its content is loaded into memory.
+class MmapStream : public SpanStream
+{
+public:
+
+    enum AccessPattern
+    {
+        Normal,
+        Sequential,
+        Random,
+    };
+
+private:
+
+    QFile *file;
+    bool mapped;
+
+    void Advise(qint64 offset, qint64 count, int advice);
+
+public:
+
+    MmapStream(const QString &path, AccessPattern pattern = AccessPattern::Normal);
+    ~MmapStream() override;
+
+    bool isMapped() { return mapped; }
+    void Close() override;
+
+    void WillNeed(qint64 offset, qint64 count);
+};
+
+#endif
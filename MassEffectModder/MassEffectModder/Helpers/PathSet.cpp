@@ -0,0 +1,71 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "PathSet.h"
+#include <Helpers/MiscHelpers.h>
+
+static bool comparePathCaseIgnore(const QString &e1, const QString &e2)
+{
+    return AsciiStringCompareCaseIgnore(e1, e2) < 0;
+}
+
+PathSet::PathSet(const QStringList &list, bool sorted)
+{
+    Build(list, sorted);
+}
+
+void PathSet::Build(const QStringList &list, bool sorted)
+{
+    paths = list;
+    if (!sorted)
+        std::sort(paths.begin(), paths.end(), comparePathCaseIgnore);
+}
+
+bool PathSet::Contains(const QString &path) const
+{
+    return std::binary_search(paths.begin(), paths.end(), path, comparePathCaseIgnore);
+}
+
+void PathSet::Diff(const PathSet &current, QStringList &added, QStringList &removed) const
+{
+    int i = 0, c = 0;
+    while (i < paths.count() && c < current.paths.count())
+    {
+        int comp = AsciiStringCompareCaseIgnore(paths[i], current.paths[c]);
+        if (comp == 0)
+        {
+            // Paths differing only by case match each other on both sides
+            const QString &path = paths[i];
+            while (i < paths.count() && AsciiStringCompareCaseIgnore(paths[i], path) == 0)
+                i++;
+            while (c < current.paths.count() && AsciiStringCompareCaseIgnore(current.paths[c], path) == 0)
+                c++;
+        }
+        else if (comp < 0)
+            removed.push_back(paths[i++]);
+        else
+            added.push_back(current.paths[c++]);
+    }
+    while (i < paths.count())
+        removed.push_back(paths[i++]);
+    while (c < current.paths.count())
+        added.push_back(current.paths[c++]);
+}
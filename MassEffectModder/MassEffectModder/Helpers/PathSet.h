@@ -0,0 +1,48 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef PATH_SET_H
+#define PATH_SET_H
+
+// Set of paths compared with ASCII case ignored. Paths are kept sorted,
+// so membership is a binary search and difference of two sets is a single
+// merge pass instead of nested loops over both lists.
+class PathSet
+{
+private:
+
+    QStringList paths;
+
+public:
+
+    PathSet() = default;
+    explicit PathSet(const QStringList &list, bool sorted = false);
+
+    void Build(const QStringList &list, bool sorted = false);
+    void Clear() { paths.clear(); }
+    int Count() const { return paths.count(); }
+    const QStringList &Paths() const { return paths; }
+    bool Contains(const QString &path) const;
+    // Paths only in "current" are returned as added, paths only in this set as removed.
+    void Diff(const PathSet &current, QStringList &added, QStringList &removed) const;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCRATCH_BUFFER_H
+#define SCRATCH_BUFFER_H
+
+#include <Helpers/Exception.h>
+
+// Growable temporary buffer meant to be reused between calls,
+// usually declared as thread_local. Buffers above MaxRetainedSize
+// are released after use to not keep large allocations per thread.
+struct ScratchBuffer
+{
+private:
+
+    quint8 *_ptr = nullptr;
+    quint64 _capacity = 0;
+
+public:
+
+    enum
+    {
+        MaxRetainedSize = 64 * 1024 * 1024, // 64MB
+    };
+
+    ScratchBuffer() = default;
+    ScratchBuffer(const ScratchBuffer &) = delete;
+    ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+    ~ScratchBuffer()
+    {
+        delete[] _ptr;
+    }
+
+    quint8 *Acquire(quint64 size)
+    {
+        if (size > _capacity)
+        {
+            delete[] _ptr;
+            _ptr = new quint8[size];
+            if (_ptr == nullptr)
+                CRASH_MSG((QString("ScratchBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
+            _capacity = size;
+        }
+        return _ptr;
+    }
+
+    void Release()
+    {
+        if (_capacity > MaxRetainedSize)
+        {
+            delete[] _ptr;
+            _ptr = nullptr;
+            _capacity = 0;
+        }
+    }
+
+    [[nodiscard]] quint64 capacity() const
+    {
+        return _capacity;
+    }
+};
+
+#endif
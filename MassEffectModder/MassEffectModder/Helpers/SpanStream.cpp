@@ -0,0 +1,301 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "SpanStream.h"
+
+SpanStream::SpanStream(const quint8 *buffer, qint64 count)
+    : data(const_cast<quint8 *>(buffer)), length(count), position(0)
+{
+    if (count < 0)
+        CRASH_MSG("SpanStream: invalid size.");
+}
+
+SpanStream::SpanStream(const ByteBuffer &buffer)
+    : SpanStream(buffer.ptr(), buffer.size())
+{
+}
+
+SpanStream::SpanStream(const ByteBuffer &buffer, qint64 offset, qint64 count)
+    : data(nullptr), length(count), position(0)
+{
+    if (offset < 0 || count < 0 || offset + count > buffer.size())
+        CRASH_MSG("SpanStream: view out of buffer.");
+    data = buffer.ptr() + offset;
+}
+
+const quint8 *SpanStream::Borrow(qint64 count)
+{
+    if (count < 0 || position + count > length)
+    {
+        CRASH_MSG("SpanStream::Borrow() - Error: read out of buffer.");
+    }
+
+    const quint8 *ptr = data + position;
+    position += count;
+    return ptr;
+}
+
+void SpanStream::CopyFrom(Stream & /*stream*/, qint64 /*count*/, qint64 /*bufferSize*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::ReadToBuffer(quint8 *buffer, qint64 count)
+{
+    if (count < 0 || position + count > length)
+    {
+        CRASH_MSG("SpanStream::ReadToBuffer() - Error: read out of buffer.");
+    }
+
+    memcpy(buffer, data + position, static_cast<size_t>(count));
+    position += count;
+}
+
+ByteBuffer SpanStream::ReadToBuffer(qint64 count)
+{
+    ByteBuffer buffer(count);
+    ReadToBuffer(buffer.ptr(), count);
+    return buffer;
+}
+
+void SpanStream::WriteFromBuffer(quint8 * /*buffer*/, qint64 /*count*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteFromBuffer(const ByteBuffer &buffer)
+{
+    WriteFromBuffer(buffer.ptr(), buffer.size());
+}
+
+void SpanStream::ReadStringASCII(QString &str, qint64 count)
+{
+    std::unique_ptr<char[]> buffer (new char[static_cast<size_t>(count) + 1]);
+
+    buffer.get()[count] = 0;
+    ReadToBuffer(reinterpret_cast<quint8 *>(buffer.get()), count);
+    str = QString(buffer.get());
+}
+
+void SpanStream::ReadStringASCIINull(QString &str)
+{
+    str = "";
+    do
+    {
+        auto c = static_cast<char>(ReadByte());
+        if (c == 0)
+            return;
+        str += c;
+    } while (position < length);
+}
+
+void SpanStream::ReadStringUnicode16(QString &str, qint64 count)
+{
+    str = "";
+    for (qint64 n = 0; n < count; n++)
+    {
+        quint16 c = ReadUInt16();
+        str += QChar(static_cast<ushort>(c));
+    }
+}
+
+void SpanStream::ReadStringUnicode16Null(QString &str)
+{
+    str = "";
+    do
+    {
+        quint16 c = ReadUInt16();
+        if (c == 0)
+            return;
+        str += QChar(static_cast<ushort>(c));
+    } while (position < length);
+}
+
+void SpanStream::WriteStringASCII(const QString & /*str*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteStringASCIINull(const QString & /*str*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteStringUnicode16(const QString & /*str*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteStringUnicode16Null(const QString & /*str*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+qint64 SpanStream::ReadInt64()
+{
+    qint64 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(qint64));
+    return value;
+}
+
+quint64 SpanStream::ReadUInt64()
+{
+    quint64 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(quint64));
+    return value;
+}
+
+qint32 SpanStream::ReadInt32()
+{
+    qint32 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(qint32));
+    return value;
+}
+
+quint32 SpanStream::ReadUInt32()
+{
+    quint32 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(quint32));
+    return value;
+}
+
+qint16 SpanStream::ReadInt16()
+{
+    qint16 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(qint16));
+    return value;
+}
+
+quint16 SpanStream::ReadUInt16()
+{
+    quint16 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(quint16));
+    return value;
+}
+
+quint8 SpanStream::ReadByte()
+{
+    quint8 value;
+    ReadToBuffer(reinterpret_cast<quint8 *>(&value), sizeof(quint8));
+    return value;
+}
+
+void SpanStream::WriteInt64(qint64 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteUInt64(quint64 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteInt32(qint32 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteUInt32(quint32 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteInt16(qint16 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteUInt16(quint16 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteByte(quint8 /*value*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::WriteZeros(qint64 /*count*/)
+{
+    CRASH_MSG("SpanStream: stream is read only.");
+}
+
+void SpanStream::Seek(qint64 offset, SeekOrigin origin)
+{
+    qint64 newPosition = 0;
+    switch (origin)
+    {
+    case SeekOrigin::Begin:
+        newPosition = offset;
+        break;
+    case SeekOrigin::Current:
+        newPosition = position + offset;
+        break;
+    case SeekOrigin::End:
+        newPosition = length + offset;
+        break;
+    }
+    if (newPosition < 0 || newPosition > length)
+    {
+        CRASH_MSG("SpanStream: out of stream.");
+    }
+    position = newPosition;
+}
+
+void SpanStream::SeekBegin()
+{
+    Seek(0, SeekOrigin::Begin);
+}
+
+void SpanStream::SeekEnd()
+{
+    Seek(0, SeekOrigin::End);
+}
+
+void SpanStream::JumpTo(qint64 offset)
+{
+    Seek(offset, SeekOrigin::Begin);
+}
+
+void SpanStream::Skip(qint64 offset)
+{
+    Seek(offset, SeekOrigin::Current);
+}
+
+void SpanStream::SkipByte()
+{
+    Seek(sizeof(quint8), SeekOrigin::Current);
+}
+
+void SpanStream::SkipInt16()
+{
+    Seek(sizeof(quint16), SeekOrigin::Current);
+}
+
+void SpanStream::SkipInt32()
+{
+    Seek(sizeof(qint32), SeekOrigin::Current);
+}
+
+void SpanStream::SkipInt64()
+{
+    Seek(sizeof(quint64), SeekOrigin::Current);
+}
@@ -0,0 +1,180 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "TaskScheduler.h"
+
+struct SchedulerStage
+{
+    std::atomic<int> cap;
+    std::atomic<quint64> loops;
+    std::atomic<quint64> serialLoops;
+    std::atomic<quint64> tasks;
+    std::atomic<quint64> queueDepth;
+    std::atomic<quint64> peakQueueDepth;
+    std::atomic<quint64> busyNs;
+    std::atomic<quint64> capacityNs;
+};
+
+static std::atomic<int> g_threads(0);
+static SchedulerStage g_stages[TaskScheduler::StagesCount];
+
+static const char *stageNames[TaskScheduler::StagesCount] =
+{
+    "package decompress", "package compress", "mod data compress", "mod data decompress",
+    "mipmap compress", "mipmap decompress", "DLC extract"
+};
+
+void TaskScheduler::SetThreads(int threads)
+{
+    g_threads = threads > 0 ? threads : 0;
+    if (threads > 0)
+        omp_set_num_threads(threads);
+}
+
+int TaskScheduler::Threads()
+{
+    int threads = g_threads;
+    return threads > 0 ? threads : omp_get_max_threads();
+}
+
+void TaskScheduler::SetStageCap(Stage stage, int maxThreads)
+{
+    g_stages[stage].cap = maxThreads > 0 ? maxThreads : 0;
+}
+
+int TaskScheduler::ThreadsFor(Stage stage, int tasks)
+{
+    if (tasks <= 1 || omp_in_parallel())
+        return 1;
+    int threads = qMin(Threads(), tasks);
+    int cap = g_stages[stage].cap;
+    if (cap > 0)
+        threads = qMin(threads, cap);
+    return qMax(threads, 1);
+}
+
+static void UpdatePeak(std::atomic<quint64> &peak, quint64 value)
+{
+    quint64 current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void TaskScheduler::ParallelFor(Stage stage, int tasks, const std::function<void(int)> &task)
+{
+    if (tasks <= 0)
+        return;
+
+    SchedulerStage &s = g_stages[stage];
+    s.loops.fetch_add(1, std::memory_order_relaxed);
+    s.tasks.fetch_add(tasks, std::memory_order_relaxed);
+    UpdatePeak(s.peakQueueDepth, s.queueDepth.fetch_add(tasks, std::memory_order_relaxed) + tasks);
+
+    int threads = ThreadsFor(stage, tasks);
+    if (threads == 1)
+    {
+        s.serialLoops.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < tasks; i++)
+        {
+            task(i);
+            s.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+    std::atomic<quint64> busyNs(0);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (int i = 0; i < tasks; i++)
+    {
+        QElapsedTimer taskTimer;
+        taskTimer.start();
+        task(i);
+        busyNs.fetch_add(taskTimer.nsecsElapsed(), std::memory_order_relaxed);
+        s.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    s.busyNs.fetch_add(busyNs, std::memory_order_relaxed);
+    s.capacityNs.fetch_add(static_cast<quint64>(wallTimer.nsecsElapsed()) * threads,
+                           std::memory_order_relaxed);
+}
+
+const char *TaskScheduler::StageName(Stage stage)
+{
+    return stageNames[stage];
+}
+
+// Command line form of stage name uses dashes instead of spaces, e.g. "mipmap-compress".
+bool TaskScheduler::StageFromName(const QString &name, Stage &stage)
+{
+    for (int i = 0; i < StagesCount; i++)
+    {
+        if (name.compare(QString(stageNames[i]).replace(' ', '-'), Qt::CaseInsensitive) == 0)
+        {
+            stage = static_cast<Stage>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+TaskScheduler::StageStats TaskScheduler::GetStats(Stage stage)
+{
+    const SchedulerStage &s = g_stages[stage];
+    StageStats stats{};
+    stats.loops = s.loops;
+    stats.serialLoops = s.serialLoops;
+    stats.tasks = s.tasks;
+    stats.queueDepth = s.queueDepth;
+    stats.peakQueueDepth = s.peakQueueDepth;
+    quint64 capacity = s.capacityNs;
+    stats.utilisation = capacity != 0 ? static_cast<double>(s.busyNs) / capacity : 0;
+    return stats;
+}
+
+void TaskScheduler::ResetStats()
+{
+    for (auto &s : g_stages)
+    {
+        s.loops = 0;
+        s.serialLoops = 0;
+        s.tasks = 0;
+        s.peakQueueDepth = s.queueDepth.load();
+        s.busyNs = 0;
+        s.capacityNs = 0;
+    }
+}
+
+QString TaskScheduler::Summary()
+{
+    QString summary = "  Threads: " + QString::number(Threads()) + "\n";
+    for (int i = 0; i < StagesCount; i++)
+    {
+        StageStats stats = GetStats(static_cast<Stage>(i));
+        if (stats.loops == 0)
+            continue;
+        summary += QString("  Scheduler %1: loops %2 (serial %3), tasks %4, peak queue %5, utilisation %6%\n")
+                   .arg(stageNames[i]).arg(stats.loops).arg(stats.serialLoops).arg(stats.tasks)
+                   .arg(stats.peakQueueDepth).arg(stats.utilisation * 100, 0, 'f', 1);
+    }
+    return summary;
+}
@@ -0,0 +1,71 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <functional>
+
+// Central place deciding how many threads parallel loops get.
+// Loops called from already running parallel region are executed on
+// the calling thread, so package level parallelism composes with block
+// level loops inside codecs without oversubscribing the CPU.
+// Tasks are taken dynamically by worker threads, so idle ones steal
+// remaining work of the loop.
+class TaskScheduler
+{
+public:
+
+    enum Stage
+    {
+        PackageDecompress,
+        PackageCompress,
+        ModDataCompress,
+        ModDataDecompress,
+        MipmapCompress,
+        MipmapDecompress,
+        DLCExtract,
+        StagesCount
+    };
+
+    struct StageStats
+    {
+        quint64 loops;
+        quint64 serialLoops; // nested or too small, run on calling thread
+        quint64 tasks;
+        quint64 queueDepth; // tasks queued and not finished yet
+        quint64 peakQueueDepth;
+        double utilisation; // busy time of workers / (wall time * threads)
+    };
+
+    static void SetThreads(int threads);
+    static int Threads();
+    static void SetStageCap(Stage stage, int maxThreads);
+    static int ThreadsFor(Stage stage, int tasks);
+    static void ParallelFor(Stage stage, int tasks, const std::function<void(int)> &task);
+    static const char *StageName(Stage stage);
+    static bool StageFromName(const QString &name, Stage &stage);
+    static StageStats GetStats(Stage stage);
+    static void ResetStats();
+    static QString Summary();
+};
+
+#endif
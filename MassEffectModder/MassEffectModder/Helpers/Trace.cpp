@@ -0,0 +1,130 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "Trace.h"
+#include <Helpers/FileStream.h>
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    quint64 start;
+    quint64 duration;
+    qint64 bytes;
+};
+
+struct TraceThreadBuffer
+{
+    std::mutex lock;
+    int threadId;
+    std::vector<TraceEvent> events;
+};
+
+std::atomic<bool> Trace::enabled(false);
+
+static std::mutex g_traceLock;
+static QString g_tracePath;
+static std::chrono::steady_clock::time_point g_traceStartTime;
+static std::vector<TraceThreadBuffer *> g_traceBuffers;
+static std::atomic<int> g_traceSession(0);
+
+// Each thread appends to own buffer, the buffers are owned by the global
+// list, so they stay valid after OpenMP worker threads exit.
+static TraceThreadBuffer *GetThreadBuffer()
+{
+    static thread_local TraceThreadBuffer *buffer = nullptr;
+    static thread_local int bufferSession = -1;
+    int session = g_traceSession.load(std::memory_order_acquire);
+    if (buffer == nullptr || bufferSession != session)
+    {
+        std::lock_guard<std::mutex> guard(g_traceLock);
+        buffer = new TraceThreadBuffer;
+        buffer->threadId = static_cast<int>(g_traceBuffers.size()) + 1;
+        g_traceBuffers.push_back(buffer);
+        bufferSession = session;
+    }
+    return buffer;
+}
+
+bool Trace::Start(const QString &path)
+{
+    std::lock_guard<std::mutex> guard(g_traceLock);
+    if (!QFileInfo(path).absoluteDir().exists())
+        return false;
+    g_tracePath = path;
+    g_traceStartTime = std::chrono::steady_clock::now();
+    g_traceSession++;
+    enabled = true;
+    return true;
+}
+
+quint64 Trace::Now()
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - g_traceStartTime).count());
+}
+
+void Trace::AddSpan(const char *name, const char *category,
+                    quint64 start, quint64 end, qint64 bytes)
+{
+    if (!enabled)
+        return;
+    TraceThreadBuffer *buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> guard(buffer->lock);
+    buffer->events.push_back({ name, category, start, end - start, bytes });
+}
+
+bool Trace::Stop()
+{
+    if (!enabled)
+        return true;
+    enabled = false;
+
+    std::lock_guard<std::mutex> guard(g_traceLock);
+    g_traceSession++;
+    FileStream fs = FileStream(g_tracePath, FileMode::Create, FileAccess::WriteOnly);
+    fs.WriteStringASCII("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fs.WriteStringASCII(QString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+                                "\"args\":{\"name\":\"%1\"}}").arg(QCoreApplication::applicationName()));
+    for (TraceThreadBuffer *buffer : g_traceBuffers)
+    {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        for (const TraceEvent &event : buffer->events)
+        {
+            QString line = QString(",\n{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\",\"pid\":1,"
+                                   "\"tid\":%3,\"ts\":%4,\"dur\":%5")
+                    .arg(event.name).arg(event.category).arg(buffer->threadId)
+                    .arg(event.start).arg(event.duration);
+            if (event.bytes >= 0)
+                line += QString(",\"args\":{\"bytes\":%1}").arg(event.bytes);
+            line += "}";
+            fs.WriteStringASCII(line);
+        }
+        delete buffer;
+    }
+    g_traceBuffers.clear();
+    fs.WriteStringASCII("\n]}\n");
+
+    return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+// Scoped performance spans written as Chrome trace-event JSON
+// (chrome://tracing, Perfetto). Spans are compiled in only with TRACE_ENABLE
+// and recorded only while a trace is started with --trace-file,
+// otherwise a span costs a single flag check.
+
+class Trace
+{
+private:
+
+    static std::atomic<bool> enabled;
+
+public:
+
+    static bool Start(const QString &path);
+    static bool Stop();
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static quint64 Now();
+    static void AddSpan(const char *name, const char *category,
+                        quint64 start, quint64 end, qint64 bytes);
+};
+
+class TraceScope
+{
+private:
+
+    const char *name;
+    const char *category;
+    quint64     start;
+    qint64      bytes;
+    bool        active;
+
+public:
+
+    TraceScope(const char *spanName, const char *spanCategory)
+        : name(spanName), category(spanCategory), start(0), bytes(-1),
+          active(Trace::IsEnabled())
+    {
+        if (active)
+            start = Trace::Now();
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    ~TraceScope()
+    {
+        if (active)
+            Trace::AddSpan(name, category, start, Trace::Now(), bytes);
+    }
+
+    void SetBytes(qint64 amount) { bytes = amount; }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if defined(TRACE_ENABLE)
+#define TRACE_SCOPE(name, category) \
+    TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#define TRACE_SCOPE_NAMED(var, name, category) TraceScope var(name, category)
+#define TRACE_BYTES(var, amount) var.SetBytes(amount)
+#else
+#define TRACE_SCOPE(name, category) do {} while (0)
+#define TRACE_SCOPE_NAMED(var, name, category) do {} while (0)
+#define TRACE_BYTES(var, amount) do {} while (0)
+#endif
+
+#endif
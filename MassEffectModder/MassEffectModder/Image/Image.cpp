@@ -20,10 +20,11 @@
  */
 
 #include <Image/Image.h>
-#include <Helpers/MemoryStream.h>
+#include <Helpers/SpanStream.h>
 #include <Helpers/FileStream.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
 #include <Wrappers.h>
 
 Image::Image(const QString &fileName, ImageFormat format)
@@ -103,7 +104,7 @@ Image::Image(const ByteBuffer &data, ImageFormat format)
         case ImageFormat::DDS:
         case ImageFormat::TGA:
         {
-            MemoryStream stream(data);
+            SpanStream stream(data);
             LoadImageFromStream(stream, format);
             return;
         }
@@ -128,7 +129,7 @@ Image::Image(const ByteBuffer &data, const QString &extension)
         case ImageFormat::DDS:
         case ImageFormat::TGA:
         {
-            MemoryStream stream(data);
+            SpanStream stream(data);
             LoadImageFromStream(stream, format);
             return;
         }
@@ -189,6 +190,50 @@ ImageFormat Image::DetectImageByExtension(const QString &extension)
     return ImageFormat::UnknownImageFormat;
 }
 
+// Read only dimensions from the image file header, without decoding the pixels.
+bool Image::ReadImageSize(const QString &fileName, int &width, int &height)
+{
+    ImageFormat format = DetectImageByFilename(fileName);
+    if (format == ImageFormat::UnknownImageFormat)
+        return false;
+
+    quint8 header[26];
+    {
+        FileStream file(fileName, FileMode::Open, FileAccess::ReadOnly);
+        if (file.Length() < (qint64)sizeof(header))
+            return false;
+        file.ReadToBuffer(header, sizeof(header));
+    }
+
+    switch (format)
+    {
+        case ImageFormat::DDS:
+            if (*reinterpret_cast<quint32 *>(header) != DDS_TAG)
+                return false;
+            height = *reinterpret_cast<qint32 *>(header + 12);
+            width = *reinterpret_cast<qint32 *>(header + 16);
+            break;
+        case ImageFormat::PNG:
+            width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+            height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+            break;
+        case ImageFormat::BMP:
+            if (*reinterpret_cast<quint16 *>(header) != BMP_TAG)
+                return false;
+            width = *reinterpret_cast<qint32 *>(header + 18);
+            height = qAbs(*reinterpret_cast<qint32 *>(header + 22));
+            break;
+        case ImageFormat::TGA:
+            width = *reinterpret_cast<quint16 *>(header + 12);
+            height = *reinterpret_cast<quint16 *>(header + 14);
+            break;
+        case ImageFormat::UnknownImageFormat:
+            return false;
+    }
+
+    return width > 0 && height > 0;
+}
+
 void Image::LoadImageFromStream(Stream &stream, ImageFormat format)
 {
     foreach(MipMap *mipmap, mipMaps)
@@ -292,7 +337,8 @@ ByteBuffer Image::convertRawToARGB(const quint8 *src, int w, int h, PixelFormat
             break;
         case PixelFormat::ARGB:
         {
-            tmpPtr = ByteBuffer(src, w * h * 4);
+            tmpPtr = ByteBuffer(PooledBuffer(w * h * 4));
+            memcpy(tmpPtr.ptr(), src, tmpPtr.size());
             break;
         }
         case PixelFormat::RGB: tmpPtr = RGBToARGB(src, w, h); break;
@@ -467,7 +513,7 @@ ByteBuffer Image::downscaleARGB(const quint8 *src, int w, int h)
         return tmpData;
     }
 
-    ByteBuffer tmpData(w * h);
+    ByteBuffer tmpData(PooledBuffer(w * h));
     quint8 *ptr = tmpData.ptr();
     int pitch = w * 4;
     for (int srcPos = 0, dstPos = 0; dstPos < w * h; srcPos += pitch)
@@ -517,14 +563,19 @@ ByteBuffer Image::downscaleRGB(const quint8 *src, int w, int h)
     return tmpData;
 }
 
-void Image::saveToPng(const quint8 *src, int w, int h, PixelFormat format, const QString &filename)
+void Image::saveToPng(const quint8 *src, int w, int h, PixelFormat format, const QString &filename,
+                      int compressionLevel, int filterMode, int numThreads)
 {
     auto dataARGB = convertRawToARGB(src, w, h, format, true);
     quint8 *buffer;
     quint32 bufferSize;
-    if (PngWrite(dataARGB.ptr(), &buffer, &bufferSize, w, h) != 0)
+    if (numThreads <= 0)
+        numThreads = omp_get_max_threads();
+    if (PngWrite(dataARGB.ptr(), &buffer, &bufferSize, w, h,
+                 compressionLevel, filterMode, numThreads) != 0)
     {
         PERROR("Failed to save to PNG.\n");
+        dataARGB.Free();
         return;
     }
     FileStream fs = FileStream(filename, FileMode::Create, FileAccess::WriteOnly);
@@ -596,6 +647,7 @@ ByteBuffer Image::convertToFormat(PixelFormat srcFormat, const quint8 *src, int
 
 void Image::correctMips(PixelFormat dstFormat, bool dxt1HasAlpha, quint8 dxt1Threshold)
 {
+    Metrics::AddTextureEncoded(dstFormat);
     MipMap *firstMip = mipMaps.first();
     auto tempData = convertRawToARGB(firstMip->getRefData().ptr(), firstMip->getWidth(), firstMip->getHeight(), pixelFormat);
 
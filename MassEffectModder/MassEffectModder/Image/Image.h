@@ -80,8 +80,8 @@ private:
     DDS_PF ddsPixelFormat{};
     uint DDSflags{};
 
-    ImageFormat DetectImageByFilename(const QString &fileName);
-    ImageFormat DetectImageByExtension(const QString &extension);
+    static ImageFormat DetectImageByFilename(const QString &fileName);
+    static ImageFormat DetectImageByExtension(const QString &extension);
     void LoadImageFromStream(Stream &stream, ImageFormat format);
     void LoadImageFromBuffer(ByteBuffer data, ImageFormat format);
     void LoadImageDDS(Stream &stream);
@@ -113,11 +113,14 @@ public:
     Image(const ByteBuffer &data, const QString &extension);
     Image(QList<MipMap *> &mipmaps, PixelFormat pixelFmt);
     ~Image();
+    static bool ReadImageSize(const QString &fileName, int &width, int &height);
     static ByteBuffer convertRawToARGB(const quint8 *src, int w, int h, PixelFormat format, bool clearAlpha = false);
     static ByteBuffer convertRawToRGB(const quint8 *src, int w, int h, PixelFormat format);
     static ByteBuffer convertRawToBGR(const quint8 *src, int w, int h, PixelFormat format);
     static ByteBuffer convertRawToAlphaGreyscale(const quint8 *src, int w, int h, PixelFormat format);
-    static void saveToPng(const quint8 *src, int w, int h, PixelFormat format, const QString &filename);
+    // filterMode is one of PNG_WRITE_FILTER_*, numThreads 0 means all available threads
+    static void saveToPng(const quint8 *src, int w, int h, PixelFormat format, const QString &filename,
+                          int compressionLevel = -1, int filterMode = -1, int numThreads = 0);
     void correctMips(PixelFormat dstFormat, bool dxt1HasAlpha = false, quint8 dxt1Threshold = 128);
     static PixelFormat getPixelFormatType(const QString &format);
     static QString getEngineFormatType(PixelFormat format);
@@ -23,6 +23,8 @@
 #include <Helpers/MemoryStream.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/TaskScheduler.h>
+#include <Helpers/Trace.h>
 #include <Wrappers.h>
 
 void Image::LoadImageDDS(Stream &stream)
@@ -490,12 +492,14 @@ void Image::writeBlock4X4ARGBATI2(const quint8 blockR[BLOCK_SIZE_4X4BPP8],
 ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const quint8 *src, int w, int h,
                                    bool useDXT1Alpha, quint8 DXT1Threshold)
 {
+    TRACE_SCOPE_NAMED(traceCompress, "Image::compressMipmap", "image");
+    TRACE_BYTES(traceCompress, static_cast<qint64>(w) * h * 4);
     int blockSize = BLOCK_SIZE_4X4BPP8;
     if (dstFormat == PixelFormat::DXT1)
         blockSize = BLOCK_SIZE_4X4BPP4;
 
-    auto dst = ByteBuffer(blockSize * (w / 4) * (h / 4));
-    int cores = omp_get_max_threads();
+    auto dst = ByteBuffer(PooledBuffer(blockSize * (w / 4) * (h / 4)));
+    int cores = TaskScheduler::ThreadsFor(TaskScheduler::MipmapCompress, h / 4 / 4);
     int partSize;
     if (w * h < 65536 || w < 256 || h < 16)
     {
@@ -510,15 +514,9 @@ ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const quint8 *src, int w
         partSize = h / 4 / cores;
     }
 
-    int range[cores + 1];
-    range[0] = 0;
-    for (int p = 1; p <= cores; p++)
-        range[p] = (partSize * p);
-
-    #pragma omp parallel for num_threads(cores)
-    for (int p = 0; p < cores; p++)
+    TaskScheduler::ParallelFor(TaskScheduler::MipmapCompress, cores, [&](int p)
     {
-        for (int y = range[p]; y < range[p + 1]; y++)
+        for (int y = partSize * p; y < partSize * (p + 1); y++)
         {
             for (int x = 0; x < w / 4; x++)
             {
@@ -561,15 +559,15 @@ ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const quint8 *src, int w
                     CRASH_MSG("Not supported codec.");
             }
         }
-    }
+    });
 
     return dst;
 }
 
 ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const quint8 *src, int w, int h)
 {
-    auto dst = ByteBuffer(w * h * 4);
-    int cores = omp_get_max_threads();
+    auto dst = ByteBuffer(PooledBuffer(w * h * 4));
+    int cores = TaskScheduler::ThreadsFor(TaskScheduler::MipmapDecompress, h / 4 / 4);
     int partSize;
     if (w * h < 65536 || w < 256 || h < 16)
     {
@@ -584,15 +582,9 @@ ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const quint8 *src, int
         partSize = h / 4 / cores;
     }
 
-    int range[cores + 1];
-    range[0] = 0;
-    for (int p = 1; p <= cores; p++)
-        range[p] = (partSize * p);
-
-    #pragma omp parallel for num_threads(cores)
-    for (int p = 0; p < cores; p++)
+    TaskScheduler::ParallelFor(TaskScheduler::MipmapDecompress, cores, [&](int p)
     {
-        for (int y = range[p]; y < range[p + 1]; y++)
+        for (int y = partSize * p; y < partSize * (p + 1); y++)
         {
             for (int x = 0; x < w / 4; x++)
             {
@@ -640,7 +632,7 @@ ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const quint8 *src, int
                     CRASH_MSG("Not supported codec.");
             }
         }
-    }
+    });
 
     return dst;
 }
@@ -29,12 +29,22 @@ SOURCES += \
     GameData/LODSettings.cpp \
     GameData/Package.cpp \
     GameData/TOCFile.cpp \
+    Helpers/BufferPool.cpp \
     Helpers/Crc32.cpp \
+    Helpers/FileHashCache.cpp \
     Helpers/FileStream.cpp \
+    Helpers/FileStreamPool.cpp \
+    Helpers/IoPolicy.cpp \
     Helpers/Logs.cpp \
+    Helpers/Metrics.cpp \
     Helpers/MemoryStream.cpp \
     Helpers/MiscHelpers.cpp \
+    Helpers/MmapStream.cpp \
+    Helpers/PathSet.cpp \
+    Helpers/SpanStream.cpp \
     Helpers/Stream.cpp \
+    Helpers/TaskScheduler.cpp \
+    Helpers/Trace.cpp \
     Image/Image.cpp \
     Image/ImageBMP.cpp \
     Image/ImageDDS.cpp \
@@ -55,6 +65,7 @@ SOURCES += \
     Program/SignalHandler.cpp \
     Resources/Resources.cpp \
     Texture/Texture.cpp \
+    Texture/TextureMapFile.cpp \
     Texture/TextureMovie.cpp \
     Texture/TextureProperty.cpp \
     Texture/TextureScan.cpp
@@ -69,6 +80,7 @@ SOURCES += \
     Gui/LayoutInstallMods.cpp \
     Gui/LayoutMain.cpp \
     Gui/LayoutTexturesManager.cpp \
+    Gui/TextureSearchIndex.cpp \
     Program/Updater.cpp
 } else {
 SOURCES += \
@@ -85,16 +97,27 @@ HEADERS += \
     GameData/LODSettings.h \
     GameData/Package.h \
     GameData/TOCFile.h \
+    Helpers/BufferPool.h \
     Helpers/ByteBuffer.h \
     Helpers/BinarySearch.h \
     Helpers/Crc32.h \
     Helpers/Exception.h \
+    Helpers/FileHashCache.h \
     Helpers/FileStream.h \
+    Helpers/FileStreamPool.h \
+    Helpers/IoPolicy.h \
     Helpers/Logs.h \
+    Helpers/Metrics.h \
     Helpers/MemoryStream.h \
     Helpers/MiscHelpers.h \
+    Helpers/MmapStream.h \
+    Helpers/PathSet.h \
+    Helpers/SpanStream.h \
     Helpers/QSort.h \
+    Helpers/ScratchBuffer.h \
     Helpers/Stream.h \
+    Helpers/TaskScheduler.h \
+    Helpers/Trace.h \
     Image/Image.h \
     Md5/MD5BadEntries.h \
     Md5/MD5ModEntries.h \
@@ -105,6 +128,7 @@ HEADERS += \
     Program/SignalHandler.h \
     Resources/Resources.h \
     Texture/Texture.h \
+    Texture/TextureMapFile.h \
     Texture/TextureMovie.h \
     Texture/TextureProperty.h \
     Texture/TextureScan.h \
@@ -116,6 +140,7 @@ HEADERS += \
     Gui/LayoutInstallMods.h \
     Gui/LayoutMain.h \
     Gui/LayoutTexturesManager.h \
+    Gui/TextureSearchIndex.h \
     Program/Updater.h
 } else {
 HEADERS += \
@@ -140,6 +165,14 @@ equals(GUI_MODE, true) {
     DEFINES += GUI
 }
 
+equals(ZSTD_ENABLE, true) {
+    DEFINES += ZSTD_ENABLE
+}
+
+equals(TRACE_ENABLE, true) {
+    DEFINES += TRACE_ENABLE
+}
+
 QMAKE_CXXFLAGS_RELEASE -= -O2
 equals(RELEASE_IN_DEBUG_MODE, true) {
     QMAKE_CXXFLAGS_RELEASE += -g
@@ -187,11 +220,8 @@ Release:LIBS += \
     -L$$OUT_PWD/../Libs/png/release -lpng \
     -L$$OUT_PWD/../Libs/xdelta3/release -lxdelta3 \
     -L$$OUT_PWD/../Libs/zlib/release -lzlib \
+    -L$$OUT_PWD/../Libs/zstd/release -lzstd \
     -L$$OUT_PWD/../Libs/unrar/release -lunrar
-
-equals(ZSTD_ENABLE, true) {
-    Release:LIBS += -L$$OUT_PWD/../Libs/zstd/release -lzstd
-}
 Debug:LIBS += \
     -L$$OUT_PWD/../Wrappers/debug -lWrappers \
     -L$$OUT_PWD/../Libs/7z/debug -l7z \
@@ -201,11 +231,8 @@ Debug:LIBS += \
     -L$$OUT_PWD/../Libs/png/debug -lpng \
     -L$$OUT_PWD/../Libs/xdelta3/debug -lxdelta3 \
     -L$$OUT_PWD/../Libs/zlib/debug -lzlib \
+    -L$$OUT_PWD/../Libs/zstd/debug -lzstd \
     -L$$OUT_PWD/../Libs/unrar/debug -lunrar
-
-equals(ZSTD_ENABLE, true) {
-    Debug:LIBS += -L$$OUT_PWD/../Libs/zstd/debug -lzstd
-}
 } else:unix: {
 LIBS += \
     -L$$OUT_PWD/../Wrappers -lWrappers \
@@ -217,11 +244,8 @@ LIBS += \
     -L$$OUT_PWD/../Libs/png -lpng \
     -L$$OUT_PWD/../Libs/xdelta3 -lxdelta3 \
     -L$$OUT_PWD/../Libs/zlib -lzlib \
+    -L$$OUT_PWD/../Libs/zstd -lzstd \
     -L$$OUT_PWD/../Libs/unrar -lunrar
-
-equals(ZSTD_ENABLE, true) {
-    LIBS += -L$$OUT_PWD/../Libs/zstd -lzstd
-}
 }
 
 macx {
@@ -232,7 +256,7 @@ macx {
 
 win32 {
     QMAKE_CXXFLAGS += -fopenmp
-    LIBS += -limagehlp -lgomp
+    LIBS += -limagehlp -lpsapi -lgomp
 }
 
 linux {
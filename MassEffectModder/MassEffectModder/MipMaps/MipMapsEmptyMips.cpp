@@ -22,6 +22,7 @@
 #include <MipMaps/MipMaps.h>
 #include <GameData/GameData.h>
 #include <Texture/Texture.h>
+#include <Helpers/IoPolicy.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
 
@@ -140,6 +141,13 @@ void MipMaps::removeMipMaps(int phase, QList<TextureMapEntry> &textures, QString
             }
         }
 
+        int prefetchIndex = i + IoPolicy::PrefetchDepth();
+        if (IoPolicy::PrefetchDepth() != 0 && prefetchIndex < list.count() &&
+            list[prefetchIndex].pkgPath != list[i].pkgPath)
+        {
+            IoPolicy::Prefetch(g_GameData->GamePath() + list[prefetchIndex].pkgPath);
+        }
+        IoPolicy::ThrottleFile(g_GameData->GamePath() + list[i].pkgPath);
         Package package{};
         if (package.Open(g_GameData->GamePath() + list[i].pkgPath) != 0)
         {
@@ -25,8 +25,13 @@
 #include <Texture/Texture.h>
 #include <Texture/TextureMovie.h>
 #include <Misc/Misc.h>
+#include <Helpers/FileStreamPool.h>
+#include <Helpers/IoPolicy.h>
+#include <Helpers/MmapStream.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/Trace.h>
 #include <Helpers/QSort.h>
 
 static const quint8 tfcNewGuid[16] = { 0xB4, 0xD2, 0xD7, 0x16, 0x08, 0x4A, 0x4B, 0x99, 0x9F, 0xC9, 0x07, 0x89, 0x87, 0xE0, 0x38, 0x21 };
@@ -103,98 +108,248 @@ void MipMaps::RemoveLowerMips(Image *image)
     }
 }
 
+struct VerifyTextureEntry
+{
+    int texturesIndex;
+    int listIndex;
+};
+
+struct VerifyPackageEntry
+{
+    QString packagePath;
+    QList<VerifyTextureEntry> textures;
+};
+
+struct VerifyMipmapRead
+{
+    int textureEntry;
+    int mipmapIndex;
+    QString storageName;
+    uint offset;
+};
+
+static bool compareVerifyPackagePath(const VerifyPackageEntry &e1, const VerifyPackageEntry &e2)
+{
+    return AsciiStringCompareCaseIgnore(e1.packagePath, e2.packagePath) < 0;
+}
+
+static bool compareVerifyMipmapRead(const VerifyMipmapRead &e1, const VerifyMipmapRead &e2)
+{
+    int compResult = AsciiStringCompareCaseIgnore(e1.storageName, e2.storageName);
+    if (compResult != 0)
+        return compResult < 0;
+    return e1.offset < e2.offset;
+}
+
+static void ReportVerifyError(const QString &ipcMessage, const QString &message)
+{
+    #pragma omp critical(verifyTexturesReport)
+    {
+        if (g_ipc)
+        {
+            ConsoleWrite(QString("[IPC]ERROR ") + ipcMessage);
+            ConsoleSync();
+        }
+        else
+        {
+            PERROR(message);
+        }
+    }
+}
+
+static bool VerifyPackageTextures(const QList<TextureMapEntry> &textures,
+                                  const VerifyPackageEntry &packageEntry, FileStreamPool &tfcPool)
+{
+    bool errors = false;
+
+    IoPolicy::ThrottleFile(g_GameData->GamePath() + packageEntry.packagePath);
+    Package package{};
+    if (package.Open(g_GameData->GamePath() + packageEntry.packagePath) != 0)
+    {
+        ReportVerifyError(QString("Failed to open package: ") + packageEntry.packagePath + " Skipping...",
+                          QString("Error: Failed to open package: ") + packageEntry.packagePath + "\nSkipping...\n");
+        return true;
+    }
+
+    // Parse all textures of the package first, then read mipmaps ordered
+    // by storage and offset, so external data is read sequentially from TFC.
+    QList<Texture *> packageTextures;
+    QList<VerifyMipmapRead> reads;
+    for (int i = 0; i < packageEntry.textures.count(); i++)
+    {
+        const VerifyTextureEntry &entry = packageEntry.textures[i];
+        const TextureMapEntry &foundTexture = textures.at(entry.texturesIndex);
+        const TextureMapPackageEntry &matchedTexture = foundTexture.list[entry.listIndex];
+        if (!g_ipc)
+        {
+            PINFO(QString("Texture: ") + QString::number(entry.texturesIndex + 1) + " of " +
+                  QString::number(textures.count()) + " " + foundTexture.name + " in " +
+                  matchedTexture.path + "\n");
+        }
+        auto exportData = package.getExportData(matchedTexture.exportID);
+        if (exportData.ptr() == nullptr)
+        {
+            ReportVerifyError(QString("Texture ") + foundTexture.name +
+                              " has broken export data in package: " +
+                              matchedTexture.path + "Export Id: " +
+                              QString::number(matchedTexture.exportID + 1) + " Skipping...",
+                              QString("Error: Texture ") + foundTexture.name +
+                              " has broken export data in package: " +
+                              matchedTexture.path + "\nExport Id: " +
+                              QString::number(matchedTexture.exportID + 1) + "\nSkipping...\n");
+            errors = true;
+            packageTextures.append(nullptr);
+            continue;
+        }
+        auto texture = new Texture(package, matchedTexture.exportID, std::move(exportData));
+        packageTextures.append(texture);
+
+        QString storageName;
+        if (texture->HasExternalMips())
+        {
+            if (GameData::gameType == MeType::ME1_TYPE)
+                storageName = texture->basePackageName;
+            else
+                storageName = texture->getProperties().getProperty("TextureFileCacheName").valueName;
+        }
+        for (int m = 0; m < matchedTexture.crcs.count(); m++)
+        {
+            VerifyMipmapRead read{};
+            read.textureEntry = i;
+            read.mipmapIndex = m;
+            if (m < texture->mipMapsList.count())
+            {
+                const Texture::TextureMipMap &mipmap = texture->mipMapsList[m];
+                if (mipmap.storageType == StorageTypes::extUnc ||
+                    mipmap.storageType == StorageTypes::extLZO ||
+                    mipmap.storageType == StorageTypes::extZlib)
+                {
+                    read.storageName = storageName;
+                    read.offset = mipmap.dataOffset;
+                }
+                else
+                {
+                    read.offset = mipmap.internalOffset;
+                }
+            }
+            reads.append(read);
+        }
+    }
+
+    std::sort(reads.begin(), reads.end(), compareVerifyMipmapRead);
+
+    for (int r = 0; r < reads.count(); r++)
+    {
+        const VerifyMipmapRead &read = reads[r];
+        const VerifyTextureEntry &entry = packageEntry.textures[read.textureEntry];
+        const TextureMapEntry &foundTexture = textures.at(entry.texturesIndex);
+        const TextureMapPackageEntry &matchedTexture = foundTexture.list[entry.listIndex];
+        Texture *texture = packageTextures[read.textureEntry];
+        ByteBuffer data = texture->getMipMapDataByIndex(read.mipmapIndex, &tfcPool);
+        uint crc = texture->getCrcData(data);
+        data.Free();
+        if (matchedTexture.crcs[read.mipmapIndex] != crc)
+        {
+            ReportVerifyError(QString("Texture ") + foundTexture.name +
+                              " CRC does not match, mipmap: " +
+                              QString::number(read.mipmapIndex) + ", Package: " +
+                              matchedTexture.path + ", Export Id: " +
+                              QString::number(matchedTexture.exportID + 1),
+                              QString("Error: Texture ") + foundTexture.name +
+                              " CRC does not match, mipmap: " +
+                              QString::number(read.mipmapIndex) + "\nPackage: " +
+                              matchedTexture.path + "\nExport Id: " +
+                              QString::number(matchedTexture.exportID + 1) + "\n");
+            errors = true;
+        }
+    }
+
+    qDeleteAll(packageTextures);
+
+    return errors;
+}
+
 bool MipMaps::VerifyTextures(QList<TextureMapEntry> &textures,
                              ProgressCallback callback, void *callbackHandle)
 {
     bool errors = false;
     int lastProgress = -1;
 
+    // Group work by package, so each package is opened only once
+    // and packages can be verified independently of each other.
+    QList<VerifyPackageEntry> packages;
+    QHash<QString, int> packagesIndex;
+    int totalEntries = 0;
     for (int k = 0; k < textures.count(); k++)
     {
-#ifdef GUI
-        QApplication::processEvents();
-#endif
-        int newProgress = (k + 1) * 100 / textures.count();
-        if (lastProgress != newProgress)
+        for (int t = 0; t < textures[k].list.count(); t++)
         {
-            lastProgress = newProgress;
-            if (g_ipc)
+            const TextureMapPackageEntry &matchedTexture = textures[k].list[t];
+            if (matchedTexture.path.length() == 0 || matchedTexture.crcs.count() == 0)
+                continue;
+            QString key = matchedTexture.path.toLower();
+            auto found = packagesIndex.find(key);
+            int index;
+            if (found == packagesIndex.end())
             {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
-                ConsoleSync();
+                VerifyPackageEntry packageEntry;
+                packageEntry.packagePath = matchedTexture.path;
+                packages.append(packageEntry);
+                index = packages.count() - 1;
+                packagesIndex.insert(key, index);
             }
-            else if (callback)
+            else
             {
-                callback(callbackHandle, newProgress, "Verifing textures");
+                index = found.value();
             }
+            packages[index].textures.append({ k, t });
+            totalEntries++;
         }
-        for (int t = 0; t < textures[k].list.count(); t++)
+    }
+    packagesIndex.clear();
+
+    std::sort(packages.begin(), packages.end(), compareVerifyPackagePath);
+
+    FileStreamPool tfcPool;
+    int processedEntries = 0;
+
+    #pragma omp parallel for schedule(dynamic) num_threads(IoPolicy::ReadThreads())
+    for (int p = 0; p < packages.count(); p++)
+    {
+        bool packageErrors = VerifyPackageTextures(textures, packages.at(p), tfcPool);
+#ifdef GUI
+        if (omp_get_thread_num() == 0)
+            QApplication::processEvents();
+#endif
+
+        #pragma omp critical(verifyTexturesProgress)
         {
-            TextureMapEntry foundTexture = textures[k];
-            if (textures[k].list[t].path.length() == 0)
-                continue;
-            TextureMapPackageEntry matchedTexture = textures[k].list[t];
-            if (matchedTexture.crcs.count() != 0)
+            if (packageErrors)
+                errors = true;
+            processedEntries += packages.at(p).textures.count();
+            int newProgress = processedEntries * 100 / totalEntries;
+            // GUI callback updates widgets, it can run on the calling thread only,
+            // so progress advances just when it is actually reported
+            bool canReport = g_ipc || (callback && omp_get_thread_num() == 0);
+            if (canReport && lastProgress != newProgress)
             {
-                if (!g_ipc)
+                lastProgress = newProgress;
+                if (g_ipc)
                 {
-                    PINFO(QString("Texture: ") + QString::number(k + 1) + " of " + QString::number(k) +
-                          + " " + foundTexture.name + " in " + matchedTexture.path + "\n");
+                    ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                    ConsoleSync();
                 }
-                Package package{};
-                if (package.Open(g_GameData->GamePath() + matchedTexture.path) != 0)
+                else
                 {
-                    auto exportData = package.getExportData(matchedTexture.exportID);
-                    if (exportData.ptr() == nullptr)
-                    {
-                        if (g_ipc)
-                        {
-                            ConsoleWrite(QString("[IPC]ERROR Texture ") + foundTexture.name +
-                                         " has broken export data in package: " +
-                                         matchedTexture.path + "Export Id: " +
-                                         QString::number(matchedTexture.exportID + 1) + " Skipping...");
-                            ConsoleSync();
-                        }
-                        else
-                        {
-                            PERROR(QString("Error: Texture ") + foundTexture.name +
-                                   " has broken export data in package: " +
-                                   matchedTexture.path + "\nExport Id: " +
-                                   QString::number(matchedTexture.exportID + 1) + "\nSkipping...\n");
-                        }
-                        errors = true;
-                        continue;
-                    }
-                    Texture texture = Texture(package, matchedTexture.exportID, exportData);
-                    exportData.Free();
-                    for (int m = 0; m < matchedTexture.crcs.count(); m++)
-                    {
-                        if (matchedTexture.crcs[m] != texture.getCrcData(texture.getMipMapDataByIndex(m)))
-                        {
-                            if (g_ipc)
-                            {
-                                ConsoleWrite(QString("[IPC]ERROR Texture ") + foundTexture.name +
-                                             " CRC does not match, mipmap: " +
-                                             QString::number(m) + ", Package: " +
-                                             matchedTexture.path + ", Export Id: " +
-                                             QString::number(matchedTexture.exportID + 1));
-                                ConsoleSync();
-                            }
-                            else
-                            {
-                                PERROR(QString("Error: Texture ") + foundTexture.name +
-                                       " CRC does not match, mipmap: " +
-                                       QString::number(m) + "\nPackage: " +
-                                       matchedTexture.path + "\nExport Id: " +
-                                       QString::number(matchedTexture.exportID + 1) + "\n");
-                            }
-                            errors = true;
-                        }
-                    }
+                    callback(callbackHandle, newProgress, "Verifing textures");
                 }
             }
         }
     }
+
+    if (!g_ipc && callback && lastProgress != 100 && packages.count() != 0)
+        callback(callbackHandle, 100, "Verifing textures");
+
     return errors;
 }
 
@@ -216,6 +371,8 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
 
     for (int e = 0; e < map.count(); e++)
     {
+        TRACE_SCOPE("MipMaps::replaceTextures package", "mipmaps");
+        MetricsTimer packageTimer(Metrics::PackageTime);
 #ifdef GUI
         QApplication::processEvents();
 #endif
@@ -245,6 +402,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
             }
         }
 
+        IoPolicy::ThrottleFile(g_GameData->GamePath() + map[e].packagePath);
         Package package{};
         if (package.Open(g_GameData->GamePath() + map[e].packagePath) != 0)
         {
@@ -290,8 +448,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
 
             if (matched.movieTexture)
             {
-                TextureMovie textureMovie = TextureMovie(package, matched.exportID, exportData);
-                exportData.Free();
+                TextureMovie textureMovie = TextureMovie(package, matched.exportID, std::move(exportData));
 
                 ByteBuffer data;
                 if (mod.injectedMovieTexture.size() != 0)
@@ -300,7 +457,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                 }
                 else
                 {
-                    FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
+                    MmapStream fs(mod.memPath, MmapStream::AccessPattern::Sequential);
                     fs.JumpTo(mod.memEntryOffset);
                     data = Misc::decompressData(fs, mod.memEntrySize);
                 }
@@ -392,13 +549,18 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             if (archiveFile.length() == 0)
                                 CRASH_MSG("No more TFC files available!");
                         }
+                        TRACE_SCOPE_NAMED(traceTfc, "TFC write", "mipmaps");
+                        TRACE_BYTES(traceTfc, data.size());
                         FileStream archiveFs = FileStream(archiveFile, FileMode::Open, FileAccess::ReadWrite);
                         archiveFs.SeekEnd();
                         textureMovie.replaceMovieData(data, archiveFs.Position());
                         archiveFs.WriteFromBuffer(data);
+                        Metrics::Add(Metrics::TfcBytesAppended, data.size());
                     }
                     else
                     {
+                        TRACE_SCOPE_NAMED(traceTfc, "TFC write", "mipmaps");
+                        TRACE_BYTES(traceTfc, data.size());
                         FileStream archiveFs = FileStream(archiveFile, FileMode::Open, FileAccess::ReadWrite);
                         archiveFs.JumpTo(textureMovie.getDataOffset());
                         archiveFs.WriteFromBuffer(data);
@@ -426,8 +588,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
             }
             else
             {
-                Texture texture = Texture(package, matched.exportID, exportData);
-                exportData.Free();
+                Texture texture = Texture(package, matched.exportID, std::move(exportData));
                 QString fmt = texture.getProperties().getProperty("Format").valueName;
                 PixelFormat pixelFormat = Image::getPixelFormatType(fmt);
                 texture.removeEmptyMips();
@@ -444,7 +605,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                     }
                     else
                     {
-                        FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
+                        MmapStream fs(mod.memPath, MmapStream::AccessPattern::Sequential);
                         fs.JumpTo(mod.memEntryOffset);
                         ByteBuffer data = Misc::decompressData(fs, mod.memEntrySize);
                         if (data.size() == 0)
@@ -474,7 +635,10 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                         newPixelFormat = changeTextureType(pixelFormat, image->getPixelFormat(), texture);
                     mod.cachedPixelFormat = newPixelFormat;
 
-                    errors += Misc::CorrectTexture(image, texture, newPixelFormat, mod.textureName);
+                    {
+                        TRACE_SCOPE("Misc::CorrectTexture", "mipmaps");
+                        errors += Misc::CorrectTexture(image, texture, newPixelFormat, mod.textureName);
+                    }
 
                     // remove lower mipmaps below 4x4 for DXT compressed textures
                     if (mod.cachedPixelFormat == PixelFormat::DXT1 ||
@@ -779,7 +943,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             }
                             else
                             {
-                                MemoryStream stream(mod.cacheCprMipmaps[m].getRefData());
+                                SpanStream stream(mod.cacheCprMipmaps[m].getRefData());
                                 auto mip = Package::decompressData(stream, mod.cacheCprMipmapsStorageType,
                                                                      mipmap.uncompressedSize,
                                                                      mod.cacheCprMipmaps[m].getRefData().size());
@@ -819,7 +983,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             }
                             else
                             {
-                                MemoryStream stream(mod.cacheCprMipmaps[m].getRefData());
+                                SpanStream stream(mod.cacheCprMipmaps[m].getRefData());
                                 auto mip = Package::decompressData(stream, mod.cacheCprMipmapsStorageType,
                                                                      mipmap.uncompressedSize,
                                                                      mod.cacheCprMipmaps[m].getRefData().size());
@@ -835,6 +999,8 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             {
                                 triggerCacheArc = true;
 
+                                TRACE_SCOPE_NAMED(traceTfc, "TFC write", "mipmaps");
+                                TRACE_BYTES(traceTfc, mipmap.newData.size());
                                 if (!newTfcFile && oldSpace)
                                 {
                                     FileStream fs = FileStream(archiveFile, FileMode::Open, FileAccess::ReadWrite);
@@ -849,6 +1015,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                                     fs.SeekEnd();
                                     mipmap.dataOffset = (uint)fs.Position();
                                     fs.WriteFromBuffer(mipmap.newData);
+                                    Metrics::Add(Metrics::TfcBytesAppended, mipmap.newData.size());
                                 }
                             }
                             else
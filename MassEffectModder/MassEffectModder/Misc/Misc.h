@@ -29,6 +29,8 @@
 #include <Texture/TextureScan.h>
 #include <Types/MemTypes.h>
 
+#include <QHash>
+
 class MipMaps;
 
 struct MD5ModFileEntry
@@ -62,6 +64,8 @@ public:
         SizeOfChunkBlock = 8,
         SizeOfChunk = 8,
         MaxBlockSize = 0x20000, // 128KB
+        DefaultConvertMemoryBudgetMB = 1024,
+        MarkerProbeMaxThreads = 16,
     };
 
     typedef void (*ProgressCallback)(void *handle, int progress, const QString &stage);
@@ -106,7 +110,8 @@ public:
     static bool compareFileInfoPath(const QFileInfo &e1, const QFileInfo &e2);
     static bool convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                                     MeType gameId, QList<TextureMapEntry> &textures, bool markToConvert,
-                                    ProgressCallback callback, void *callbackHandle);
+                                    ProgressCallback callback, void *callbackHandle,
+                                    int memoryBudgetMB = 0, bool useZstd = false);
     static void RepackME23(MeType gameId, bool appendMarker, QStringList &pkgsToRepack,
                            ProgressCallback callback, void *callbackHandle);
     static bool InstallMods(MeType gameId, Resources &resources, QStringList &modFiles,
@@ -150,7 +155,10 @@ public:
     static bool DetectMarkToConvertFromFile(const QString &file);
     static bool DetectHashFromFile(const QString &file);
     static int GetNumberOfMipsFromMap(TextureMapEntry &f);
-    static QByteArray calculateMD5(const QString &filePath);
+    static QByteArray calculateMD5(const QString &filePath, bool *succeeded = nullptr);
+    static void OpenMD5Cache();
+    static QByteArray calculateMD5Cached(const QString &filePath);
+    static QHash<QString, QByteArray> calculateMD5s(const QStringList &paths);
     static void detectMods(QStringList &mods);
     static bool detectMod(MeType gameId);
     static void detectBrokenMod(QStringList &mods);
@@ -161,8 +169,10 @@ public:
                                QStringList &mods, ProgressCallback callback,
                                void *callbackHandle);
     static void Repack(MeType gameId, ProgressCallback callback, void *callbackHandle);
-    static bool compressData(ByteBuffer inputData, Stream &ouputStream);
+    static bool compressData(ByteBuffer inputData, Stream &ouputStream, bool useZstd = false);
     static ByteBuffer decompressData(Stream &stream, long compressedSize);
+    static bool decompressData(Stream &stream, long compressedSize, quint8 *dst, uint dstSize);
+    static uint getDecompressedDataSize(Stream &stream, long compressedSize);
 };
 
 #endif
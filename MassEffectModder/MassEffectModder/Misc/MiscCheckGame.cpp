@@ -25,7 +25,12 @@
 #include <Md5/MD5BadEntries.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Trace.h>
 #include <Helpers/FileStream.h>
+#include <Helpers/FileHashCache.h>
+#include <Helpers/IoPolicy.h>
+
+#include <QVector>
 
 static bool generateModsMd5Entries = false;
 static bool generateMd5Entries = false;
@@ -66,31 +71,50 @@ bool Misc::checkGameFilesSub(FileStream *fs, QStringList &files, QList<MD5FileEn
                              QString &errors, QStringList &mods,
                              ProgressCallback callback, void *callbackHandle)
 {
-    int vanilla = true;
+    // Files are hashed first with read concurrency matched to the storage,
+    // then compared in the original order.
+    QVector<QByteArray> md5s(files.count());
+    int processed = 0;
+    #pragma omp parallel for schedule(dynamic) num_threads(IoPolicy::ReadThreads())
     for (int index = 0; index < files.count(); index++)
     {
 #ifdef GUI
-        QApplication::processEvents();
+        if (omp_get_thread_num() == 0)
+            QApplication::processEvents();
 #endif
-        int newProgress = (index + progress) * 100 / allFilesCount;
-        if (lastProgress != newProgress)
+        md5s[index] = calculateMD5Cached(g_GameData->GamePath() + files.at(index));
+
+        #pragma omp critical(checkGameFilesProgress)
         {
-            lastProgress = newProgress;
-            if (g_ipc)
+            int newProgress = (processed + progress) * 100 / allFilesCount;
+            processed++;
+            // GUI callback updates widgets, it can run on the calling thread only,
+            // so progress advances just when it is actually reported
+            bool canReport = g_ipc || (callback && omp_get_thread_num() == 0);
+            if (canReport && lastProgress != newProgress)
             {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
-                ConsoleSync();
+                lastProgress = newProgress;
+                if (g_ipc)
+                {
+                    ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                    ConsoleSync();
+                }
+            }
+            if (!g_ipc && !callback)
+            {
+                PINFO("Checking: " + files.at(index) + "\n");
+            }
+            if (callback && omp_get_thread_num() == 0)
+            {
+                callback(callbackHandle, newProgress, "Checking file: " + files.at(index));
             }
         }
-        if (!g_ipc && !callback)
-        {
-            PINFO("Checking: " + files[index] + "\n");
-        }
-        if (callback)
-        {
-            callback(callbackHandle, newProgress, "Checking file: " + files[index]);
-        }
-        QByteArray md5 = calculateMD5(g_GameData->GamePath() + files[index]);
+    }
+
+    int vanilla = true;
+    for (int index = 0; index < files.count(); index++)
+    {
+        const QByteArray &md5 = md5s[index];
         bool found = false;
         for (int p = 0; p < entries.count(); p++)
         {
@@ -216,6 +240,7 @@ bool Misc::checkGameFilesSub(FileStream *fs, QStringList &files, QList<MD5FileEn
 bool Misc::checkGameFiles(MeType gameType, Resources &resources, QString &errors, QStringList &mods,
                             ProgressCallback callback, void *callbackHandle)
 {
+    TRACE_SCOPE("Misc::checkGameFiles", "check");
     QList<MD5FileEntry> entries;
 
     if (gameType == MeType::ME1_TYPE)
@@ -247,6 +272,7 @@ bool Misc::checkGameFiles(MeType gameType, Resources &resources, QString &errors
     if (generateMd5Entries)
         fs = new FileStream("MD5FileEntryME" + QString::number((int)gameType) + ".cpp", FileMode::Create, FileAccess::WriteOnly);
 
+    OpenMD5Cache();
     int lastProgress = -1;
     bool vanilla = true;
     bool state;
@@ -284,6 +310,7 @@ bool Misc::checkGameFiles(MeType gameType, Resources &resources, QString &errors
         fs->Close();
         delete fs;
     }
+    FileHashCache::Save();
 
     return vanilla;
 }
@@ -24,6 +24,10 @@
 #include <Wrappers.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/SpanStream.h>
+#include <Helpers/ScratchBuffer.h>
+#include <Helpers/TaskScheduler.h>
 
 uint Misc::scanFilenameForCRC(const QString &inputFile)
 {
@@ -200,9 +204,10 @@ bool Misc::CheckMEMHeader(FileStream &fs, const QString &file)
 {
     uint tag = fs.ReadUInt32();
     uint version = fs.ReadUInt32();
-    if (tag != TextureModTag || version != TextureModVersion)
+    if (tag != TextureModTag ||
+        (version != TextureModVersion && version != TextureModVersionZstd))
     {
-        if (version != TextureModVersion)
+        if (version != TextureModVersion && version != TextureModVersionZstd)
         {
             PERROR(QString("File ") + BaseName(file) + " was made with an older version of MEM, skipping...\n");
         }
@@ -349,9 +354,158 @@ bool Misc::DetectHashFromFile(const QString &file)
     return idx > 0;
 }
 
+struct ConvertJob
+{
+    BinaryMod mod;
+    TextureMapEntry texture;
+    QString file;
+    QString imageExtension;
+    int entryIndex;
+    bool imageFromFile;
+    bool valid;
+    ByteBuffer output;
+};
+
+static void ProcessConvertJob(ConvertJob &job, MeType gameId, bool useZstd)
+{
+    BinaryMod &mod = job.mod;
+    TextureMapEntry &f = job.texture;
+
+    if (job.imageFromFile || job.imageExtension.length() != 0)
+    {
+        std::unique_ptr<Image> image;
+        if (job.imageFromFile)
+            image = std::unique_ptr<Image>(new Image(job.file, ImageFormat::UnknownImageFormat));
+        else
+            image = std::unique_ptr<Image>(new Image(mod.data, job.imageExtension));
+
+        if (mod.forceHash && image->getMipMaps().count() != 0)
+        {
+            f.width = image->getMipMaps().first()->getOrigWidth();
+            f.height = image->getMipMaps().first()->getOrigHeight();
+        }
+
+        if (!Misc::CheckImage(*image, f, job.file, job.entryIndex))
+        {
+            mod.data.Free();
+            return;
+        }
+
+        bool storeImage = job.imageFromFile;
+        if (!mod.forceHash)
+        {
+            PixelFormat newPixelFormat = f.pixfmt;
+            if (mod.markConvert)
+            {
+                newPixelFormat = Misc::changeTextureType(gameId, f.pixfmt, image->getPixelFormat(), f.flags);
+                if (f.pixfmt == newPixelFormat)
+                    PINFO(QString("Warning for texture: ") + mod.textureName +
+                          " This texture can not be converted to desired format...\n");
+            }
+
+            int numMips = Misc::GetNumberOfMipsFromMap(f);
+            if (Misc::CorrectTexture(*image, f, numMips, newPixelFormat, job.file))
+                storeImage = true;
+        }
+
+        if (storeImage)
+        {
+            mod.data.Free();
+            mod.data = image->StoreImageToDDS();
+        }
+    }
+
+    if (mod.data.size() != 0)
+    {
+        MemoryStream dst;
+        Misc::compressData(mod.data, dst, useZstd);
+        job.output = dst.ToArray();
+        mod.size = job.output.size();
+    }
+    mod.data.Free();
+    job.valid = true;
+}
+
+static void WriteConvertJob(FileStream &outFs, ConvertJob &job, QList<FileMod> &modFiles)
+{
+    BinaryMod &mod = job.mod;
+    FileMod fileMod{};
+    fileMod.offset = outFs.Position();
+    fileMod.size = mod.size;
+
+    if (mod.binaryModType == 1 || mod.binaryModType == 2)
+    {
+        fileMod.tag = mod.binaryModType == 1 ? FileBinaryTag : FileXdeltaTag;
+        if (mod.packagePath.contains("/DLC/", Qt::CaseInsensitive))
+        {
+            QString dlcName = mod.packagePath.split(QChar('/'))[3];
+            fileMod.name = "D" + QString::number(dlcName.size()) + "-" + dlcName + "-";
+        }
+        else
+        {
+            fileMod.name = "B";
+        }
+        fileMod.name += QString::number(BaseName(mod.packagePath).size()) +
+                "-" + BaseName(mod.packagePath) +
+                "-E" + QString::number(mod.exportId);
+        fileMod.name += mod.binaryModType == 1 ? ".bin" : ".xdelta";
+
+        outFs.WriteInt32(mod.exportId);
+        outFs.WriteStringASCIINull(mod.packagePath.replace('/', '\\'));
+    }
+    else
+    {
+        if (mod.markConvert)
+            fileMod.tag = FileTextureTag2;
+        else if (mod.movieTexture)
+            fileMod.tag = FileMovieTextureTag;
+        else
+            fileMod.tag = FileTextureTag;
+        fileMod.name = mod.textureName + QString().asprintf("_0x%08X", mod.textureCrc);
+        if (mod.movieTexture)
+            fileMod.name += ".bik";
+        else
+            fileMod.name += ".dds";
+        outFs.WriteStringASCIINull(mod.textureName);
+        outFs.WriteUInt32(mod.textureCrc);
+    }
+    if (job.output.size() != 0)
+        outFs.WriteFromBuffer(job.output);
+    modFiles.push_back(fileMod);
+}
+
+// Entries are decoded, converted and compressed in parallel,
+// then written to the output in the same order they were queued.
+static void FlushConvertJobs(QList<ConvertJob> &jobs, FileStream &outFs,
+                             QList<FileMod> &modFiles, MeType gameId, bool useZstd)
+{
+    if (jobs.count() == 0)
+        return;
+
+#ifdef GUI
+    QApplication::processEvents();
+#endif
+
+    int numJobs = jobs.count();
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < numJobs; i++)
+    {
+        ProcessConvertJob(jobs[i], gameId, useZstd);
+    }
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        if (jobs[i].valid)
+            WriteConvertJob(outFs, jobs[i], modFiles);
+        jobs[i].output.Free();
+    }
+    jobs.clear();
+}
+
 bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                                MeType gameId, QList<TextureMapEntry> &textures, bool markToConvert,
-                               ProgressCallback callback, void *callbackHandle)
+                               ProgressCallback callback, void *callbackHandle, int memoryBudgetMB,
+                               bool useZstd)
 {
     PINFO("Mods conversion started...\n");
 
@@ -361,9 +515,18 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
     QStringList ddsList;
     int numEntries = 0;
 
-    QList<BinaryMod> mods = QList<BinaryMod>();
+    QList<ConvertJob> jobs = QList<ConvertJob>();
     QList<FileMod> modFiles = QList<FileMod>();
 
+    quint64 memoryBudget;
+    if (memoryBudgetMB > 0)
+        memoryBudget = (quint64)memoryBudgetMB * 1024 * 1024;
+    else
+        memoryBudget = qMax((quint64)DetectAmountMemoryGB() * 1024 * 1024 * 1024 / 4,
+                            (quint64)DefaultConvertMemoryBudgetMB * 1024 * 1024);
+    quint64 pendingBytes = 0;
+    bool zstdEntries = useZstd;
+
     QString dir = DirName(memFilePath);
     if (dir != memFilePath)
         QDir().mkpath(dir);
@@ -384,11 +547,11 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
 #ifdef GUI
         QApplication::processEvents();
 #endif
-        foreach (BinaryMod mod, mods)
+        if (pendingBytes >= memoryBudget)
         {
-            mod.data.Free();
+            FlushConvertJobs(jobs, outFs, modFiles, gameId, useZstd);
+            pendingBytes = 0;
         }
-        mods.clear();
 
         QString file = files[n].absoluteFilePath();
         if (g_ipc)
@@ -421,9 +584,17 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             if (!CheckMEMHeader(fs, file))
                 continue;
 
+            fs.JumpTo(4);
+            if (fs.ReadUInt32() == TextureModVersionZstd)
+                zstdEntries = true;
+
             if (!CheckMEMGameVersion(fs, file, gameId))
                 continue;
 
+            // keep entries order, queued entries go first
+            FlushConvertJobs(jobs, outFs, modFiles, gameId, useZstd);
+            pendingBytes = 0;
+
             int numFiles = fs.ReadInt32();
             for (int l = 0; l < numFiles; l++)
             {
@@ -470,7 +641,8 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             int numEntries = ReadModHeader(fs);
             for (int i = 0; i < numEntries; i++)
             {
-                BinaryMod mod{};
+                ConvertJob job{};
+                BinaryMod &mod = job.mod;
 #ifdef GUI
                 QApplication::processEvents();
 #endif
@@ -520,40 +692,32 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                         }
                         continue;
                     }
-                    TextureMapEntry f = textures[index];
-                    mod.textureCrc = f.crc;
-                    mod.textureName = f.name;
+                    job.texture = textures[index];
+                    job.imageExtension = "dds";
+                    mod.textureCrc = job.texture.crc;
+                    mod.textureName = job.texture.name;
                     mod.binaryModType = 0;
                     mod.data = fs.ReadToBuffer(fs.ReadInt32());
-
-                    Image image = Image(mod.data, ImageFormat::DDS);
-                    if (!CheckImage(image, f, file, i))
-                        continue;
-
-                    PixelFormat newPixelFormat = f.pixfmt;
-                    if (markToConvert)
-                    {
-                        newPixelFormat = changeTextureType(gameId, f.pixfmt, image.getPixelFormat(), f.flags);
-                        if (f.pixfmt == newPixelFormat)
-                            PINFO(QString("Warning for texture: ") + mod.textureName +
-                                  " This texture can not be converted to desired format...\n");
-                    }
-
-                    int numMips = GetNumberOfMipsFromMap(f);
-                    if (CorrectTexture(image, f, numMips, newPixelFormat, file))
-                    {
-                        mod.data.Free();
-                        mod.data = image.StoreImageToDDS();
-                    }
+                    pendingBytes += (quint64)job.texture.width * job.texture.height * 4;
                 }
                 mod.markConvert = markToConvert;
-                mods.push_back(mod);
+                job.file = file;
+                job.entryIndex = i;
+                pendingBytes += mod.data.size();
+                jobs.push_back(job);
+                // single big mod can hold many entries, keep the budget per entry
+                if (pendingBytes >= memoryBudget)
+                {
+                    FlushConvertJobs(jobs, outFs, modFiles, gameId, useZstd);
+                    pendingBytes = 0;
+                }
             }
         }
         else if (file.endsWith(".bin", Qt::CaseInsensitive) ||
             file.endsWith(".xdelta", Qt::CaseInsensitive))
         {
-            BinaryMod mod{};
+            ConvertJob job{};
+            BinaryMod &mod = job.mod;
             QString dlcName;
             QString pkgName;
             if (!ParseBinaryModFileName(file, pkgName, dlcName, mod.exportId))
@@ -590,7 +754,10 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             else if (file.endsWith(".xdelta", Qt::CaseInsensitive))
                 mod.binaryModType = 2;
             mod.data = FileStream(file, FileMode::Open).ReadAllToBuffer();
-            mods.push_back(mod);
+            job.file = file;
+            job.entryIndex = -1;
+            pendingBytes += mod.data.size();
+            jobs.push_back(job);
         }
         else if (file.endsWith(".tpf", Qt::CaseInsensitive))
         {
@@ -637,7 +804,8 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
 
             for (int i = 0; i < numEntries; i++)
             {
-                BinaryMod mod{};
+                ConvertJob job{};
+                BinaryMod &mod = job.mod;
 #ifdef GUI
                 QApplication::processEvents();
 #endif
@@ -667,8 +835,8 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                     continue;
                 }
 
-                TextureMapEntry f = FoundTextureInTheMap(textures, crc);
-                if (f.crc == 0)
+                job.texture = FoundTextureInTheMap(textures, crc);
+                if (job.texture.crc == 0)
                 {
                     PINFO(QString("Texture skipped. File ") + fileName + QString().asprintf("_0x%08X", crc) +
                         " is not present in your game setup - mod: " + BaseName(file) + "\n");
@@ -676,7 +844,7 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                     continue;
                 }
 
-                QString textureName = f.name;
+                QString textureName = job.texture.name;
                 mod.textureName = textureName;
                 mod.binaryModType = 0;
                 mod.textureCrc = crc;
@@ -699,30 +867,17 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                     continue;
                 }
 
-                Image image = Image(mod.data, GetFileExtension(fileName));
-                if (!CheckImage(image, f, file, i))
-                {
-                    mod.data.Free();
-                    continue;
-                }
-
-                PixelFormat newPixelFormat = f.pixfmt;
-                if (markToConvert)
-                {
-                    newPixelFormat = changeTextureType(gameId, f.pixfmt, image.getPixelFormat(), f.flags);
-                    if (f.pixfmt == newPixelFormat)
-                        PINFO(QString("Warning for texture: ") + mod.textureName +
-                              " This texture can not be converted to desire format...\n");
-                }
-
-                int numMips = GetNumberOfMipsFromMap(f);
-                if (CorrectTexture(image, f, numMips, newPixelFormat, file))
+                mod.markConvert = markToConvert;
+                job.file = file;
+                job.imageExtension = GetFileExtension(fileName);
+                job.entryIndex = i;
+                pendingBytes += mod.data.size() + (quint64)job.texture.width * job.texture.height * 4;
+                jobs.push_back(job);
+                if (pendingBytes >= memoryBudget)
                 {
-                    mod.data.Free();
-                    mod.data = image.StoreImageToDDS();
+                    FlushConvertJobs(jobs, outFs, modFiles, gameId, useZstd);
+                    pendingBytes = 0;
                 }
-                mod.markConvert = markToConvert;
-                mods.push_back(mod);
                 ZipGoToNextFile(handle);
             }
             goto end;
@@ -746,8 +901,9 @@ end:
                  file.endsWith(".bmp", Qt::CaseInsensitive) ||
                  file.endsWith(".tga", Qt::CaseInsensitive))
         {
-            BinaryMod mod{};
-            TextureMapEntry f;
+            ConvertJob job{};
+            BinaryMod &mod = job.mod;
+            TextureMapEntry &f = job.texture;
             bool entryMarkToConvert = markToConvert;
             uint crc = scanFilenameForCRC(file);
             if (crc == 0)
@@ -756,8 +912,8 @@ end:
             if (DetectMarkToConvertFromFile(file))
                 entryMarkToConvert = true;
 
-            bool forceHash = DetectHashFromFile(file);
-            if (!forceHash)
+            mod.forceHash = DetectHashFromFile(file);
+            if (!mod.forceHash)
             {
                 f = FoundTextureInTheMap(textures, crc);
                 if (f.crc == 0)
@@ -767,12 +923,8 @@ end:
                     continue;
                 }
             }
-
-            Image image(file, ImageFormat::UnknownImageFormat);
-            if (forceHash)
+            else
             {
-                f.width = image.getMipMaps().first()->getOrigWidth();
-                f.height = image.getMipMaps().first()->getOrigHeight();
                 QString filename = BaseName(file);
                 int idx = filename.indexOf("0x");
                 if (idx > 1)
@@ -780,34 +932,20 @@ end:
                 f.name += "-hash";
             }
 
-            if (!Misc::CheckImage(image, f, file, -1))
-                continue;
-
-            if (!forceHash)
-            {
-                PixelFormat newPixelFormat = f.pixfmt;
-                if (entryMarkToConvert)
-                {
-                    newPixelFormat = changeTextureType(gameId, f.pixfmt, image.getPixelFormat(), f.flags);
-                    if (f.pixfmt == newPixelFormat)
-                        PINFO(QString("Warning for texture: ") + mod.textureName +
-                              " This texture can not be converted to desired format...\n");
-                }
-
-                int numMips = Misc::GetNumberOfMipsFromMap(f);
-                CorrectTexture(image, f, numMips, newPixelFormat, file);
-            }
-
-            mod.data = image.StoreImageToDDS();
             mod.textureName = f.name;
             mod.binaryModType = 0;
             mod.textureCrc = crc;
             mod.markConvert = entryMarkToConvert;
-            mods.push_back(mod);
+            job.file = file;
+            job.imageFromFile = true;
+            job.entryIndex = -1;
+            pendingBytes += files[n].size() + (quint64)f.width * f.height * 4;
+            jobs.push_back(job);
         }
         else if (file.endsWith(".bik", Qt::CaseInsensitive))
         {
-            BinaryMod mod{};
+            ConvertJob job{};
+            BinaryMod &mod = job.mod;
             TextureMapEntry f;
 
             uint crc = scanFilenameForCRC(file);
@@ -886,93 +1024,13 @@ end:
             mod.movieTexture = true;
             mod.textureCrc = crc;
             mod.markConvert = false;
-            mods.push_back(mod);
+            job.file = file;
+            job.entryIndex = -1;
+            pendingBytes += mod.data.size();
+            jobs.push_back(job);
         }
-
-        for (int l = 0; l < mods.count(); l++)
-        {
-#ifdef GUI
-            QApplication::processEvents();
-#endif
-            FileMod fileMod{};
-            std::unique_ptr<Stream> dst (new MemoryStream());
-            if (mods[l].data.size() != 0)
-            {
-                Misc::compressData(mods[l].data, *dst);
-                dst->SeekBegin();
-                fileMod.offset = outFs.Position();
-                fileMod.size = dst->Length();
-            }
-            else
-            {
-                fileMod.offset = mods[l].offset;
-                fileMod.size = mods[l].size;
-            }
-
-            if (mods[l].binaryModType == 1)
-            {
-                fileMod.tag = FileBinaryTag;
-                if (mods[l].packagePath.contains("/DLC/", Qt::CaseInsensitive))
-                {
-                    QString dlcName = mods[l].packagePath.split(QChar('/'))[3];
-                    fileMod.name = "D" + QString::number(dlcName.size()) + "-" + dlcName + "-";
-                }
-                else
-                {
-                    fileMod.name = "B";
-                }
-                fileMod.name += QString::number(BaseName(mods[l].packagePath).size()) +
-                        "-" + BaseName(mods[l].packagePath) +
-                        "-E" + QString::number(mods[l].exportId) + ".bin";
-
-                outFs.WriteInt32(mods[l].exportId);
-                outFs.WriteStringASCIINull(mods[l].packagePath.replace('/', '\\'));
-            }
-            else if (mods[l].binaryModType == 2)
-            {
-                fileMod.tag = FileXdeltaTag;
-                if (mods[l].packagePath.contains("/DLC/", Qt::CaseInsensitive))
-                {
-                    QString dlcName = mods[l].packagePath.split(QChar('/'))[3];
-                    fileMod.name = "D" + QString::number(dlcName.size()) + "-" + dlcName + "-";
-                }
-                else
-                {
-                    fileMod.name = "B";
-                }
-                fileMod.name += QString::number(BaseName(mods[l].packagePath).size()) +
-                        "-" + BaseName(mods[l].packagePath) +
-                        "-E" + QString::number(mods[l].exportId) + ".xdelta";
-
-                outFs.WriteInt32(mods[l].exportId);
-                outFs.WriteStringASCIINull(mods[l].packagePath.replace('/', '\\'));
-            }
-            else
-            {
-                if (mods[l].markConvert)
-                    fileMod.tag = FileTextureTag2;
-                else if (mods[l].movieTexture)
-                    fileMod.tag = FileMovieTextureTag;
-                else
-                    fileMod.tag = FileTextureTag;
-                fileMod.name = mods[l].textureName + QString().asprintf("_0x%08X", mods[l].textureCrc);
-                if (mods[l].movieTexture)
-                    fileMod.name += ".bik";
-                else
-                    fileMod.name += ".dds";
-                outFs.WriteStringASCIINull(mods[l].textureName);
-                outFs.WriteUInt32(mods[l].textureCrc);
-            }
-            if (mods[l].data.size() != 0)
-                outFs.CopyFrom(*dst, dst->Length());
-            modFiles.push_back(fileMod);
-        }
-    }
-    foreach (BinaryMod mod, mods)
-    {
-        mod.data.Free();
     }
-    mods.clear();
+    FlushConvertJobs(jobs, outFs, modFiles, gameId, useZstd);
 
     if (modFiles.count() == 0)
     {
@@ -993,7 +1051,7 @@ end:
     qint64 pos = outFs.Position();
     outFs.SeekBegin();
     outFs.WriteUInt32(TextureModTag);
-    outFs.WriteUInt32(TextureModVersion);
+    outFs.WriteUInt32(zstdEntries ? TextureModVersionZstd : TextureModVersion);
     outFs.WriteInt64(pos);
     outFs.JumpTo(pos);
     outFs.WriteUInt32((uint)gameId);
@@ -1033,7 +1091,8 @@ bool Misc::extractMEM(MeType gameId, QFileInfoList &inputList, QString &outputDi
         FileStream fs = FileStream(inputList[i].absoluteFilePath(), FileMode::Open, FileAccess::ReadOnly);
         uint tag = fs.ReadUInt32();
         uint version = fs.ReadUInt32();
-        if (tag != TextureModTag || version != TextureModVersion)
+        if (tag != TextureModTag ||
+            (version != TextureModVersion && version != TextureModVersionZstd))
             continue;
         fs.JumpTo(fs.ReadInt64());
         fs.SkipInt32();
@@ -1380,134 +1439,210 @@ failed:
     return status;
 }
 
-bool Misc::compressData(ByteBuffer inputData, Stream &ouputStream)
+// Per thread scratch memory reused by MEM data block codec
+struct BlockCodecContext
 {
-    uint compressedSize = 0;
-    uint dataBlockLeft = inputData.size();
-    uint newNumBlocks = ((uint)inputData.size() + ModsDataEnums::MaxBlockSize - 1) / ModsDataEnums::MaxBlockSize;
-    QList<Package::ChunkBlock> blocks{};
-    {
-        MemoryStream inputStream = MemoryStream(inputData);
-        // skip blocks header and table - filled later
-        ouputStream.JumpTo(ModsDataEnums::SizeOfChunk + ModsDataEnums::SizeOfChunkBlock * newNumBlocks);
+    ScratchBuffer compressed;
+    ScratchBuffer table;
 
-        for (uint b = 0; b < newNumBlocks; b++)
-        {
-            Package::ChunkBlock block{};
-            block.uncomprSize = qMin((uint)ModsDataEnums::MaxBlockSize, dataBlockLeft);
-            dataBlockLeft -= block.uncomprSize;
-            block.uncompressedBuffer = new quint8[block.uncomprSize];
-            if (block.uncompressedBuffer == nullptr)
-                CRASH_MSG((QString("Out of memory! - amount: ") +
-                           QString::number(block.uncomprSize)).toStdString().c_str());
-            inputStream.ReadToBuffer(block.uncompressedBuffer, block.uncomprSize);
-            blocks.push_back(block);
-        }
+    void Release()
+    {
+        compressed.Release();
+        table.Release();
     }
+};
+
+static thread_local BlockCodecContext g_blockCodecContext;
+
+bool Misc::compressData(ByteBuffer inputData, Stream &ouputStream, bool useZstd)
+{
+    uint dataSize = inputData.size();
+    uint newNumBlocks = (dataSize + ModsDataEnums::MaxBlockSize - 1) / ModsDataEnums::MaxBlockSize;
+    uint blockBound;
+    if (useZstd)
+        blockBound = ZstdCompressBound(ModsDataEnums::MaxBlockSize);
+    else
+        blockBound = ZlibCompressBound(ModsDataEnums::MaxBlockSize);
+
+    // every block is compressed into own slot of arena, sizes go to table
+    Metrics::Add(useZstd ? Metrics::BytesCompressedZstd : Metrics::BytesCompressedZlib, dataSize);
+
+    BlockCodecContext &context = g_blockCodecContext;
+    quint8 *compressed = context.compressed.Acquire((quint64)blockBound * newNumBlocks);
+    auto *table = reinterpret_cast<uint *>(context.table.Acquire(sizeof(uint) * 2 * newNumBlocks));
 
     bool failed = false;
-    #pragma omp parallel for
-    for (int b = 0; b < blocks.count(); b++)
+    TaskScheduler::ParallelFor(TaskScheduler::ModDataCompress, (int)newNumBlocks, [&](int b)
     {
-        Package::ChunkBlock block = blocks[b];
-        if (ZlibCompress(block.uncompressedBuffer, block.uncomprSize, &block.compressedBuffer, &block.comprSize) == -100)
+        uint uncomprSize = qMin((uint)ModsDataEnums::MaxBlockSize, dataSize - b * ModsDataEnums::MaxBlockSize);
+        uint comprSize = blockBound;
+        quint8 *src = inputData.ptr() + (quint64)b * ModsDataEnums::MaxBlockSize;
+        quint8 *dst = compressed + (quint64)b * blockBound;
+        int result;
+        if (useZstd)
+            result = ZstdCompressToBuffer(src, uncomprSize, dst, &comprSize);
+        else
+            result = ZlibCompressToBuffer(src, uncomprSize, dst, &comprSize);
+        if (result == -100)
             CRASH_MSG("Out of memory!");
-        if (block.comprSize == 0)
+        if (comprSize == 0)
         {
             failed = true;
         }
-        blocks[b] = block;
-    }
+        table[b * 2] = comprSize;
+        table[b * 2 + 1] = uncomprSize;
+    });
 
-    foreach (Package::ChunkBlock block, blocks)
+    if (failed)
     {
-        if (!failed)
-        {
-            ouputStream.WriteFromBuffer(block.compressedBuffer, (int)block.comprSize);
-            compressedSize += block.comprSize;
-        }
-        delete[] block.uncompressedBuffer;
-        delete[] block.compressedBuffer;
+        context.Release();
+        return false;
     }
 
-    if (failed)
-        return false;
+    uint compressedSize = 0;
+    for (uint b = 0; b < newNumBlocks; b++)
+        compressedSize += table[b * 2];
 
-    ouputStream.SeekBegin();
+    if (useZstd)
+        ouputStream.WriteUInt32(DataZstdTag);
     ouputStream.WriteUInt32(compressedSize);
-    ouputStream.WriteInt32(inputData.size());
-    foreach (Package::ChunkBlock block, blocks)
+    ouputStream.WriteInt32(dataSize);
+    for (uint b = 0; b < newNumBlocks; b++)
     {
-        ouputStream.WriteUInt32(block.comprSize);
-        ouputStream.WriteUInt32(block.uncomprSize);
+        ouputStream.WriteUInt32(table[b * 2]);
+        ouputStream.WriteUInt32(table[b * 2 + 1]);
     }
+    for (uint b = 0; b < newNumBlocks; b++)
+    {
+        ouputStream.WriteFromBuffer(compressed + (quint64)b * blockBound, table[b * 2]);
+    }
+
+    context.Release();
 
     return true;
 }
 
-ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
+static bool ReadCompressedDataHeader(Stream &stream, long compressedSize, uint &compressedChunkSize,
+                                     uint &uncompressedChunkSize, uint &blocksCount, bool &useZstd)
 {
-    uint compressedChunkSize = stream.ReadUInt32();
-    uint uncompressedChunkSize = stream.ReadUInt32();
-    auto data = ByteBuffer(uncompressedChunkSize);
-    uint blocksCount = (uncompressedChunkSize + ModsDataEnums::MaxBlockSize - 1) / ModsDataEnums::MaxBlockSize;
-    if ((compressedChunkSize + ModsDataEnums::SizeOfChunk + ModsDataEnums::SizeOfChunkBlock * blocksCount) != (uint)compressedSize)
+    useZstd = false;
+    compressedChunkSize = stream.ReadUInt32();
+    uncompressedChunkSize = stream.ReadUInt32();
+    blocksCount = (uncompressedChunkSize + Misc::MaxBlockSize - 1) / Misc::MaxBlockSize;
+    if ((compressedChunkSize + Misc::SizeOfChunk + Misc::SizeOfChunkBlock * blocksCount) == (uint)compressedSize)
+        return true;
+
+    // zstd entries have extra tag in front of chunk header
+    if (compressedChunkSize != DataZstdTag)
+        return false;
+    compressedChunkSize = uncompressedChunkSize;
+    uncompressedChunkSize = stream.ReadUInt32();
+    blocksCount = (uncompressedChunkSize + Misc::MaxBlockSize - 1) / Misc::MaxBlockSize;
+    if ((compressedChunkSize + sizeof(uint) + Misc::SizeOfChunk +
+         Misc::SizeOfChunkBlock * blocksCount) != (uint)compressedSize)
     {
-        return ByteBuffer{};
+        return false;
     }
+    useZstd = true;
+
+    return true;
+}
+
+uint Misc::getDecompressedDataSize(Stream &stream, long compressedSize)
+{
+    qint64 position = stream.Position();
+    uint compressedChunkSize, uncompressedChunkSize, blocksCount;
+    bool useZstd;
+    bool valid = ReadCompressedDataHeader(stream, compressedSize, compressedChunkSize,
+                                          uncompressedChunkSize, blocksCount, useZstd);
+    stream.JumpTo(position);
+    if (!valid)
+        return 0;
+
+    return uncompressedChunkSize;
+}
 
-    QList<Package::ChunkBlock> blocks{};
+bool Misc::decompressData(Stream &stream, long compressedSize, quint8 *dst, uint dstSize)
+{
+    uint compressedChunkSize, uncompressedChunkSize, blocksCount;
+    bool useZstd;
+    if (!ReadCompressedDataHeader(stream, compressedSize, compressedChunkSize,
+                                  uncompressedChunkSize, blocksCount, useZstd))
+    {
+        return false;
+    }
+    if (uncompressedChunkSize != dstSize)
+        return false;
+
+    // table is converted in place to blocks offsets:
+    // compressed offset, compressed size, uncompressed offset, uncompressed size
+    BlockCodecContext &context = g_blockCodecContext;
+    auto *table = reinterpret_cast<uint *>(context.table.Acquire(sizeof(uint) * 4 * blocksCount));
+    uint compressedOffset = 0, uncompressedOffset = 0;
     for (uint b = 0; b < blocksCount; b++)
     {
-        Package::ChunkBlock block{};
-        block.comprSize = stream.ReadUInt32();
-        block.uncomprSize = stream.ReadUInt32();
-        blocks.push_back(block);
+        uint comprSize = stream.ReadUInt32();
+        uint uncomprSize = stream.ReadUInt32();
+        table[b * 4] = compressedOffset;
+        table[b * 4 + 1] = comprSize;
+        table[b * 4 + 2] = uncompressedOffset;
+        table[b * 4 + 3] = uncomprSize;
+        compressedOffset += comprSize;
+        uncompressedOffset += uncomprSize;
+    }
+    if (compressedOffset != compressedChunkSize || uncompressedOffset != uncompressedChunkSize)
+    {
+        context.Release();
+        return false;
     }
 
-    for (int b = 0; b < blocks.count(); b++)
+    // memory backed stream: decompress straight from its buffer
+    quint8 *compressed;
+    auto spanStream = dynamic_cast<SpanStream *>(&stream);
+    if (spanStream)
+    {
+        compressed = const_cast<quint8 *>(spanStream->Borrow(compressedChunkSize));
+    }
+    else
     {
-        Package::ChunkBlock block = blocks[b];
-        block.compressedBuffer = new quint8[block.comprSize];
-        if (block.compressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(block.comprSize)).toStdString().c_str());
-        stream.ReadToBuffer(block.compressedBuffer, block.comprSize);
-        block.uncompressedBuffer = new quint8[ModsDataEnums::MaxBlockSize * 2];
-        if (block.uncompressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(ModsDataEnums::MaxBlockSize * 2)).toStdString().c_str());
-        blocks[b] = block;
+        compressed = context.compressed.Acquire(compressedChunkSize);
+        stream.ReadToBuffer(compressed, compressedChunkSize);
     }
 
     bool failed = false;
-    #pragma omp parallel for
-    for (int b = 0; b < blocks.count(); b++)
+    TaskScheduler::ParallelFor(TaskScheduler::ModDataDecompress, (int)blocksCount, [&](int b)
     {
-        uint dstLen = ModsDataEnums::MaxBlockSize * 2;
-        Package::ChunkBlock block = blocks[b];
-        if (ZlibDecompress(block.compressedBuffer, block.comprSize, block.uncompressedBuffer, &dstLen) == -100)
+        uint dstLen = table[b * 4 + 3];
+        int result;
+        if (useZstd)
+            result = ZstdDecompress(compressed + table[b * 4], table[b * 4 + 1], dst + table[b * 4 + 2], &dstLen);
+        else
+            result = ZlibDecompress(compressed + table[b * 4], table[b * 4 + 1], dst + table[b * 4 + 2], &dstLen);
+        if (result == -100)
             CRASH_MSG("Out of memory!");
-        if (dstLen != block.uncomprSize)
+        if (dstLen != table[b * 4 + 3])
         {
             failed = true;
         }
-    }
+    });
 
-    int dstPos = 0;
-    foreach (Package::ChunkBlock block, blocks)
-    {
-        if (!failed)
-        {
-            memcpy(data.ptr() + dstPos, block.uncompressedBuffer, block.uncomprSize);
-            dstPos += block.uncomprSize;
-        }
-        delete[] block.uncompressedBuffer;
-        delete[] block.compressedBuffer;
-    }
+    context.Release();
 
-    if (failed)
+    if (!failed)
+        Metrics::Add(useZstd ? Metrics::BytesDecompressedZstd : Metrics::BytesDecompressedZlib, dstSize);
+
+    return !failed;
+}
+
+ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
+{
+    uint size = getDecompressedDataSize(stream, compressedSize);
+    if (size == 0)
+        return ByteBuffer{};
+
+    PooledBuffer data(size);
+    if (!decompressData(stream, compressedSize, data.ptr(), size))
         return ByteBuffer{};
 
-    return data;
+    return ByteBuffer(std::move(data));
 }
@@ -28,7 +28,13 @@
 #include <Md5/MD5BadEntries.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Trace.h>
 #include <Helpers/FileStream.h>
+#include <Helpers/FileHashCache.h>
+#include <Helpers/IoPolicy.h>
+
+#include <QVector>
+#include <functional>
 
 bool Misc::ApplyLAAForME1Exe()
 {
@@ -145,7 +151,7 @@ bool Misc::applyModTag(MeType gameId, int MeuitmV, int AlotV)
     return true;
 }
 
-bool Misc::CheckForMarkers(ProgressCallback callback, void *callbackHandle)
+static QStringList getPackagesForMarkers()
 {
     QString path;
     if (GameData::gameType == MeType::ME1_TYPE)
@@ -160,113 +166,133 @@ bool Misc::CheckForMarkers(ProgressCallback callback, void *callbackHandle)
             continue;
         packages.push_back(g_GameData->packageFiles[i]);
     }
+    return packages;
+}
+
+typedef std::function<void (int index, bool marker)> MarkerProbeAction;
 
+// Reads marker at the end of packages in parallel. Probing is bound by file
+// open and read latency rather than CPU, so more threads than cores are used.
+static bool probeMarkers(const QStringList &packages, bool stopOnFirst, bool ipcProgress,
+                         const QString &stage, const MarkerProbeAction &action,
+                         Misc::ProgressCallback callback, void *callbackHandle)
+{
+    std::atomic<bool> found(false);
+    int processed = 0;
     int lastProgress = -1;
+    int threads = qMin(omp_get_max_threads() * 2, (int)Misc::MarkerProbeMaxThreads);
+
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads)
     for (int i = 0; i < packages.count(); i++)
     {
-        int newProgress = (i + 1) * 100 / packages.count();
-        if ((newProgress - lastProgress) >= 5)
-        {
-            lastProgress = newProgress;
-            if (g_ipc)
-            {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
-                ConsoleSync();
-            }
-            else if (callback)
-            {
-                callback(callbackHandle, newProgress, "Checking markers");
-            }
-        }
+        if (stopOnFirst && found)
+            continue;
 
-        FileStream fs = FileStream(g_GameData->GamePath() + packages[i], FileMode::Open, FileAccess::ReadOnly);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        if (marker == QString(MEMendFileMarker))
+        quint8 tail[MEMMarkerLength];
+        bool marker = ReadFileTail(g_GameData->GamePath() + packages[i], tail, MEMMarkerLength) &&
+                memcmp(tail, MEMendFileMarker, MEMMarkerLength) == 0;
+        if (marker)
+            found = true;
+        if (action)
+            action(i, marker);
+
+        #pragma omp critical(probeMarkersProgress)
         {
-            if (g_ipc)
-            {
-                ConsoleWrite(QString("[IPC]ERROR_FILEMARKER_FOUND ") + packages[i]);
-                ConsoleSync();
-            }
-            else
+            processed++;
+            int newProgress = processed * 100 / packages.count();
+            // GUI callback updates widgets, it can run on the calling thread only,
+            // so progress advances just when it is actually reported
+            bool ipcReport = g_ipc && ipcProgress;
+            bool canReport = ipcReport || (callback && omp_get_thread_num() == 0);
+            if (canReport && (newProgress - lastProgress) >= 5)
             {
-                PERROR(QString("Error: detected marker: ") + packages[i] + "\n");
+                lastProgress = newProgress;
+                if (ipcReport)
+                {
+                    ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                    ConsoleSync();
+                }
+                else
+                {
+                    callback(callbackHandle, newProgress, stage);
+                }
             }
         }
     }
 
-    return true;
+    if (!(g_ipc && ipcProgress) && callback && lastProgress != 100 && packages.count() != 0)
+        callback(callbackHandle, 100, stage);
+
+    return found;
 }
 
-bool Misc::MarkersPresent(ProgressCallback callback, void *callbackHandle)
+bool Misc::CheckForMarkers(ProgressCallback callback, void *callbackHandle)
 {
-    QString path;
-    if (GameData::gameType == MeType::ME1_TYPE)
-        path = "/BioGame/CookedPC/testVolumeLight_VFX.upk";
-    else if (GameData::gameType == MeType::ME2_TYPE)
-        path = "/BioGame/CookedPC/BIOC_Materials.pcc";
+    QStringList packages = getPackagesForMarkers();
+    QVector<bool> markers(packages.count(), false);
+    probeMarkers(packages, false, true, "Checking markers",
+                 [&markers](int index, bool marker) { markers[index] = marker; },
+                 callback, callbackHandle);
 
-    QStringList packages;
-    for (int i = 0; i < g_GameData->packageFiles.count(); i++)
-    {
-        if (path.length() != 0 && AsciiStringMatchCaseIgnore(g_GameData->packageFiles[i], path))
-            continue;
-        packages.push_back(g_GameData->packageFiles[i]);
-    }
-
-    int lastProgress = -1;
     for (int i = 0; i < packages.count(); i++)
     {
-        int newProgress = (i + 1) * 100 / packages.count();
-        if ((newProgress - lastProgress) >= 5)
+        if (!markers[i])
+            continue;
+        if (g_ipc)
         {
-            lastProgress = newProgress;
-            if (callback)
-            {
-                callback(callbackHandle, newProgress, "Checking markers");
-            }
+            ConsoleWrite(QString("[IPC]ERROR_FILEMARKER_FOUND ") + packages[i]);
+            ConsoleSync();
         }
-
-        FileStream fs = FileStream(g_GameData->GamePath() + packages[i], FileMode::Open, FileAccess::ReadOnly);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        if (marker == QString(MEMendFileMarker))
+        else
         {
-            return true;
+            PERROR(QString("Error: detected marker: ") + packages[i] + "\n");
         }
     }
 
-    return false;
+    return true;
 }
 
-void Misc::detectBrokenMod(QStringList &mods)
+bool Misc::MarkersPresent(ProgressCallback callback, void *callbackHandle)
 {
-    for (int l = 0; l < badMODSize; l++)
+    return probeMarkers(getPackagesForMarkers(), true, false, "Checking markers",
+                        nullptr, callback, callbackHandle);
+}
+
+static void detectModsFromEntries(const MD5ModFileEntry *entries, int entriesCount,
+                                  QStringList &mods)
+{
+    QStringList paths;
+    for (int l = 0; l < entriesCount; l++)
+        paths.push_back(g_GameData->GamePath() + entries[l].path);
+    QHash<QString, QByteArray> md5s = Misc::calculateMD5s(paths);
+
+    for (int l = 0; l < entriesCount; l++)
     {
-        QString path = g_GameData->GamePath() + badMOD[l].path;
-        if (!QFile(path).exists())
+        auto md5 = md5s.constFind(paths[l]);
+        if (md5 == md5s.constEnd())
             continue;
-        QByteArray md5 = calculateMD5(path);
-        if (memcmp(md5.data(), badMOD[l].md5, 16) == 0)
+        if (memcmp(md5.value().data(), entries[l].md5, 16) == 0)
         {
             bool found = false;
             for (int s = 0; s < mods.count(); s++)
             {
-                if (AsciiStringMatch(mods[s], badMOD[l].modName))
+                if (AsciiStringMatch(mods[s], entries[l].modName))
                 {
                     found = true;
                     break;
                 }
             }
             if (!found)
-                mods.push_back(badMOD[l].modName);
+                mods.push_back(entries[l].modName);
         }
     }
 }
 
+void Misc::detectBrokenMod(QStringList &mods)
+{
+    detectModsFromEntries(badMOD, badMODSize, mods);
+}
+
 bool Misc::ReportBadMods()
 {
     QStringList badMods;
@@ -342,62 +368,25 @@ void Misc::AddMarkers(QStringList &pkgsToMarker,
         ConsoleWrite("[IPC]STAGE_CONTEXT STAGE_MARKERS");
         ConsoleSync();
     }
-    int lastProgress = -1;
-    for (int i = 0; i < pkgsToMarker.count(); i++)
-    {
-        int newProgress = (i + 1) * 100 / pkgsToMarker.count();
-        if ((newProgress - lastProgress) >= 5)
-        {
-            lastProgress = newProgress;
-            if (g_ipc)
-            {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
-                ConsoleSync();
-            }
-            else if (callback)
-            {
-                callback(callbackHandle, newProgress, "Adding markers");
-            }
-        }
-        PDEBUG(QString("Misc::AddMarkers File: ") + pkgsToMarker[i] + "\n");
-        FileStream fs = FileStream(g_GameData->GamePath() + pkgsToMarker[i], FileMode::Open, FileAccess::ReadWrite);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        QString str(MEMendFileMarker);
-        if (marker != str)
-        {
-            fs.SeekEnd();
-            fs.WriteStringASCII(str);
-        }
-    }
+    probeMarkers(pkgsToMarker, false, true, "Adding markers",
+                 [&pkgsToMarker](int index, bool marker)
+                 {
+                     if (marker)
+                         return;
+                     PDEBUG(QString("Misc::AddMarkers File: ") + pkgsToMarker[index] + "\n");
+                     FileStream fs = FileStream(g_GameData->GamePath() + pkgsToMarker[index],
+                                                FileMode::Open, FileAccess::ReadWrite);
+                     fs.SeekEnd();
+                     fs.WriteStringASCII(QString(MEMendFileMarker));
+                 },
+                 callback, callbackHandle);
     PINFO("Adding markers finished.\n\n");
 }
 
 
 void Misc::detectMods(QStringList &mods)
 {
-    for (int l = 0; l < modsEntriesSize; l++)
-    {
-        QString path = g_GameData->GamePath() + modsEntries[l].path;
-        if (!QFile(path).exists())
-            continue;
-        QByteArray md5 = calculateMD5(path);
-        if (memcmp(md5.data(), modsEntries[l].md5, 16) == 0)
-        {
-            bool found = false;
-            for (int s = 0; s < mods.count(); s++)
-            {
-                if (AsciiStringMatch(mods[s], modsEntries[l].modName))
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-                mods.push_back(modsEntries[l].modName);
-        }
-    }
+    detectModsFromEntries(modsEntries, modsEntriesSize, mods);
 }
 
 void Misc::RepackME23(MeType gameId, bool appendMarker, QStringList &pkgsToRepack,
@@ -450,6 +439,7 @@ void Misc::RepackME23(MeType gameId, bool appendMarker, QStringList &pkgsToRepac
         {
             delete package;
             package = new Package();
+            IoPolicy::ThrottleFile(g_GameData->GamePath() + pkgsToRepack[i]);
             package->Open(g_GameData->GamePath() + pkgsToRepack[i]);
             package->SaveToFile(true, false, appendMarker);
         }
@@ -458,14 +448,91 @@ void Misc::RepackME23(MeType gameId, bool appendMarker, QStringList &pkgsToRepac
     PINFO("Repack finished.\n\n");
 }
 
-QByteArray Misc::calculateMD5(const QString &filePath)
+QByteArray Misc::calculateMD5(const QString &filePath, bool *succeeded)
 {
+    TRACE_SCOPE_NAMED(traceMd5, "Misc::calculateMD5", "check");
+    if (succeeded)
+        *succeeded = false;
     QFile file(filePath);
     if (file.open(QIODevice::ReadOnly))
-        return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5);
+    {
+        TRACE_BYTES(traceMd5, file.size());
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        QByteArray buffer(IoPolicy::ReadChunkSize(), Qt::Uninitialized);
+        for (;;)
+        {
+            qint64 readBytes = file.read(buffer.data(), buffer.size());
+            if (readBytes < 0)
+                return QByteArray(16, 0);
+            if (readBytes == 0)
+                break;
+            IoPolicy::Throttle(readBytes);
+            hash.addData(buffer.constData(), static_cast<int>(readBytes));
+        }
+        if (succeeded)
+            *succeeded = true;
+        return hash.result();
+    }
     return QByteArray(16, 0);
 }
 
+void Misc::OpenMD5Cache()
+{
+    QString path = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation).first() +
+            "/MassEffectModder";
+    if (!QDir(path).exists())
+        QDir(path).mkpath(path);
+    FileHashCache::Open(path + QString("/me%1hashes.bin").arg((int)GameData::gameType),
+                        g_GameData->GamePath());
+}
+
+QByteArray Misc::calculateMD5Cached(const QString &filePath)
+{
+    QByteArray md5;
+    if (FileHashCache::Lookup(filePath, md5))
+        return md5;
+
+    FileHashStatus status;
+    bool haveStatus = FileHashCache::GetStatus(filePath, status);
+    bool succeeded;
+    md5 = calculateMD5(filePath, &succeeded);
+    // failed read must not stick in cache as a modified file
+    if (succeeded && haveStatus)
+        FileHashCache::Store(filePath, md5, status);
+    return md5;
+}
+
+QHash<QString, QByteArray> Misc::calculateMD5s(const QStringList &paths)
+{
+    QHash<QString, QByteArray> md5s;
+    QStringList uniquePaths;
+    foreach (const QString &path, paths)
+    {
+        if (md5s.contains(path) || !QFile(path).exists())
+            continue;
+        md5s.insert(path, QByteArray());
+        uniquePaths.push_back(path);
+    }
+
+    OpenMD5Cache();
+    QVector<QByteArray> results(uniquePaths.count());
+    #pragma omp parallel for schedule(dynamic) num_threads(IoPolicy::ReadThreads())
+    for (int i = 0; i < uniquePaths.count(); i++)
+    {
+        results[i] = calculateMD5Cached(uniquePaths[i]);
+#ifdef GUI
+        if (omp_get_thread_num() == 0)
+            QApplication::processEvents();
+#endif
+    }
+
+    for (int i = 0; i < uniquePaths.count(); i++)
+        md5s[uniquePaths[i]] = results[i];
+    FileHashCache::Save();
+
+    return md5s;
+}
+
 void Misc::Repack(MeType gameId, ProgressCallback callback, void *callbackHandle)
 {
     QStringList pkgsToRepack;
@@ -133,6 +133,9 @@ void Exception(const char *file, const char *func, int line, const char *msg)
         LogCrash(output, message);
     }
 
+    if (g_logs)
+        g_logs->Drain();
+
     exit(1);
 }
 
@@ -22,6 +22,7 @@
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
 #include <Helpers/Crc32.h>
+#include <Helpers/MmapStream.h>
 #include <Wrappers.h>
 #include <GameData/Package.h>
 #include <GameData/GameData.h>
@@ -30,13 +31,20 @@
 #include <Types/MemTypes.h>
 
 Texture::Texture(Package &package, int exportId, const ByteBuffer &data, bool fixDim)
+    : Texture(package, exportId, ByteBuffer(data.ptr(), data.size()), fixDim)
 {
+}
+
+Texture::Texture(Package &package, int exportId, ByteBuffer &&data, bool fixDim)
+{
+    exportData = data;
     dataExportId = exportId;
-    properties = new TextureProperty(package, data);
-    if (data.size() == properties->propertyEndOffset)
+    properties = new TextureProperty(package, exportData);
+    if (exportData.size() == properties->propertyEndOffset)
         return;
 
-    textureData = new MemoryStream(data, properties->propertyEndOffset, data.size() - properties->propertyEndOffset);
+    textureData = new SpanStream(exportData, properties->propertyEndOffset,
+                                 exportData.size() - properties->propertyEndOffset);
     if (GameData::gameType != MeType::ME3_TYPE)
     {
         textureData->Skip(12); // 12 zeros
@@ -141,6 +149,7 @@ Texture::Texture(Package &package, int exportId, const ByteBuffer &data, bool fi
 Texture::~Texture()
 {
     delete textureData;
+    exportData.Free();
     restOfData.Free();
     delete properties;
     for (int i = 0; i < mipMapsList.count(); i++)
@@ -161,6 +170,7 @@ void Texture::replaceMipMaps(const QList<TextureMipMap> &newMipMaps)
     mipMapsList = newMipMaps;
 
     delete textureData;
+    exportData.Free();
     textureData = new MemoryStream();
     if (GameData::gameType != MeType::ME3_TYPE)
     {
@@ -191,8 +201,8 @@ uint Texture::getCrcData(ByteBuffer data)
     if (data.ptr() == nullptr)
         return 0;
     if (properties->getProperty("Format").valueName == "PF_NormalMap_HQ") // only ME1 and ME2
-        return ~crc32_16bytes_prefetch(data.ptr(), data.size() / 2);
-    return ~crc32_16bytes_prefetch(data.ptr(), data.size());
+        return ~crc32_parallel(data.ptr(), data.size() / 2);
+    return ~crc32_parallel(data.ptr(), data.size());
 }
 
 uint Texture::getCrcMipmap(TextureMipMap &mipmap)
@@ -283,15 +293,15 @@ const ByteBuffer Texture::getTopImageData()
     return getMipMapData(m);
 }
 
-const ByteBuffer Texture::getMipMapDataByIndex(int index)
+const ByteBuffer Texture::getMipMapDataByIndex(int index, FileStreamPool *streamPool)
 {
     if (mipMapsList.count() == 0 || index < 0 || index >= mipMapsList.count())
         return ByteBuffer();
 
-    return getMipMapData(mipMapsList[index]);
+    return getMipMapData(mipMapsList[index], streamPool);
 }
 
-const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap)
+const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap, FileStreamPool *streamPool)
 {
     ByteBuffer mipMapData;
 
@@ -307,7 +317,7 @@ const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap)
     case StorageTypes::pccZlib:
         {
             textureData->JumpTo(mipmap.internalOffset);
-            mipMapData = Package::decompressData(dynamic_cast<Stream &>(*textureData), mipmap.storageType, mipmap.uncompressedSize, mipmap.compressedSize);
+            mipMapData = Package::decompressData(*textureData, mipmap.storageType, mipmap.uncompressedSize, mipmap.compressedSize);
             if (mipMapData.ptr() == nullptr)
             {
                 PERROR(QString("\nPackage: ") + packagePath +
@@ -390,11 +400,22 @@ const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap)
                        "\nExternal file offset: " + QString::number(mipmap.dataOffset) + "\n");
                 return ByteBuffer();
             }
-            auto fs = FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
-            fs.JumpTo(mipmap.dataOffset);
+            FileStream *pooledFs = nullptr;
+            std::unique_ptr<MmapStream> mappedFs;
+            Stream *fs;
+            if (streamPool)
+            {
+                fs = pooledFs = streamPool->Acquire(filename);
+            }
+            else
+            {
+                mappedFs.reset(new MmapStream(filename, MmapStream::AccessPattern::Random));
+                fs = mappedFs.get();
+            }
+            fs->JumpTo(mipmap.dataOffset);
             if (mipmap.storageType == StorageTypes::extLZO || mipmap.storageType == StorageTypes::extZlib)
             {
-                mipMapData = Package::decompressData(dynamic_cast<Stream &>(fs), mipmap.storageType, mipmap.uncompressedSize, mipmap.compressedSize);
+                mipMapData = Package::decompressData(*fs, mipmap.storageType, mipmap.uncompressedSize, mipmap.compressedSize);
                 if (mipMapData.ptr() == nullptr)
                 {
                     PERROR(QString("\nFile: ") + filename +
@@ -402,13 +423,14 @@ const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap)
                         "\nStorageType: " + QString::number(mipmap.storageType) +
                         "\nExport Id: " + QString::number(dataExportId + 1) +
                         "\nExternal file offset: " + QString::number(mipmap.dataOffset) + "\n");
-                    return ByteBuffer();
                 }
             }
             else
             {
-                mipMapData = fs.ReadToBuffer(mipmap.uncompressedSize);
+                mipMapData = fs->ReadToBuffer(mipmap.uncompressedSize);
             }
+            if (streamPool)
+                streamPool->Release(filename, pooledFs);
             break;
         }
     case StorageTypes::empty:
@@ -420,7 +442,17 @@ const ByteBuffer Texture::getMipMapData(TextureMipMap &mipmap)
 
 const ByteBuffer Texture::toArray(uint pccTextureDataOffset, bool updateOffset)
 {
-    MemoryStream newData;
+    qint64 size = 20 + restOfData.size();
+    for (int l = 0; l < mipMapsList.count(); l++)
+    {
+        size += 24;
+        if (mipMapsList[l].storageType == StorageTypes::pccUnc)
+            size += mipMapsList[l].uncompressedSize;
+        else if (mipMapsList[l].storageType == StorageTypes::pccLZO ||
+                 mipMapsList[l].storageType == StorageTypes::pccZlib)
+            size += mipMapsList[l].compressedSize;
+    }
+    MemoryStream newData(size);
     if (GameData::gameType != MeType::ME3_TYPE)
     {
         newData.WriteZeros(16);
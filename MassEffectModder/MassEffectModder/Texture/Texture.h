@@ -23,7 +23,9 @@
 #define TEXTURE_H
 
 #include <Helpers/FileStream.h>
+#include <Helpers/FileStreamPool.h>
 #include <Helpers/MemoryStream.h>
+#include <Helpers/SpanStream.h>
 #include <GameData/Package.h>
 #include <Texture/TextureProperty.h>
 
@@ -31,7 +33,8 @@ class Texture
 {
 private:
 
-    MemoryStream *textureData = nullptr;
+    ByteBuffer exportData;
+    Stream *textureData = nullptr;
     ByteBuffer restOfData;
     QString packagePath;
     TextureProperty *properties;
@@ -59,6 +62,8 @@ public:
     int dataExportId;
 
     Texture(Package &package, int exportId, const ByteBuffer &data, bool fixDim = true);
+    // Takes ownership of data, texture reads it in place and frees it on destruction.
+    Texture(Package &package, int exportId, ByteBuffer &&data, bool fixDim = true);
     ~Texture();
     void replaceMipMaps(const QList<TextureMipMap> &newMipMaps);
     TextureProperty& getProperties() { return *properties; }
@@ -72,8 +77,8 @@ public:
     const TextureMipMap& getMipmap(int width, int height);
     bool hasImageData();
     const ByteBuffer getTopImageData();
-    const ByteBuffer getMipMapDataByIndex(int index);
-    const ByteBuffer getMipMapData(TextureMipMap &mipmap);
+    const ByteBuffer getMipMapDataByIndex(int index, FileStreamPool *streamPool = nullptr);
+    const ByteBuffer getMipMapData(TextureMipMap &mipmap, FileStreamPool *streamPool = nullptr);
     void removeEmptyMips();
     bool hasEmptyMips();
     int numNotEmptyMips();
@@ -0,0 +1,242 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <QSaveFile>
+
+#include <Texture/TextureMapFile.h>
+#include <Helpers/MemoryStream.h>
+#include <Helpers/Logs.h>
+
+bool TextureMapFile::Open(const QString &path)
+{
+    Close();
+    if (!QFile(path).exists())
+        return false;
+
+    fs = new FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+    uint tag = fs->ReadUInt32();
+    version = fs->ReadUInt32();
+    if (tag != textureMapBinTag ||
+        (version != textureMapBinVersion && version != textureMapBinVersionNoIndex))
+    {
+        Close();
+        return false;
+    }
+
+    texturesCount = fs->ReadInt32();
+    if (version == textureMapBinVersionNoIndex)
+    {
+        texturesOffset = fs->Position();
+        return true;
+    }
+
+    texturesOffset = fs->ReadInt64();
+    qint64 texturesIndexOffset = fs->ReadInt64();
+    packagesOffset = fs->ReadInt64();
+    textureOffsets.resize(texturesCount);
+    fs->JumpTo(texturesIndexOffset);
+    fs->ReadToBuffer(reinterpret_cast<quint8 *>(textureOffsets.data()),
+                     texturesCount * static_cast<qint64>(sizeof(qint64)));
+    return true;
+}
+
+void TextureMapFile::Close()
+{
+    delete fs;
+    fs = nullptr;
+    version = 0;
+    texturesCount = 0;
+    texturesOffset = packagesOffset = 0;
+    textureOffsets.clear();
+}
+
+// Version 2 has no index, walk the textures once skipping over the records.
+void TextureMapFile::ScanTextureOffsets()
+{
+    if (textureOffsets.count() == texturesCount && packagesOffset != 0)
+        return;
+
+    textureOffsets.resize(texturesCount);
+    fs->JumpTo(texturesOffset);
+    for (int i = 0; i < texturesCount; i++)
+    {
+        textureOffsets[i] = fs->Position();
+        fs->Skip(fs->ReadInt32());
+        fs->SkipInt32();
+        uint countPackages = fs->ReadUInt32();
+        for (uint k = 0; k < countPackages; k++)
+        {
+            fs->Skip(8);
+            fs->Skip(fs->ReadInt32());
+        }
+    }
+    packagesOffset = fs->Position();
+}
+
+void TextureMapFile::ReadTextureEntry(TextureMapEntry &texture)
+{
+    int len = fs->ReadInt32();
+    fs->ReadStringASCII(texture.name, len);
+    texture.crc = fs->ReadUInt32();
+    uint countPackages = fs->ReadUInt32();
+    texture.list = QList<TextureMapPackageEntry>();
+    texture.list.reserve(countPackages);
+    for (uint k = 0; k < countPackages; k++)
+    {
+        TextureMapPackageEntry matched{};
+        matched.exportID = fs->ReadInt32();
+        matched.linkToMaster = fs->ReadInt32();
+        if (matched.linkToMaster == -2)
+        {
+            matched.linkToMaster = -1;
+            matched.movieTexture = true;
+        }
+        len = fs->ReadInt32();
+        fs->ReadStringASCII(matched.path, len);
+        matched.path.replace(QChar('\\'), QChar('/'));
+        texture.list.push_back(matched);
+    }
+}
+
+QStringList TextureMapFile::ReadPackages()
+{
+    QStringList packages;
+    if (fs == nullptr)
+        return packages;
+
+    if (version == textureMapBinVersionNoIndex)
+        ScanTextureOffsets();
+    fs->JumpTo(packagesOffset);
+    int numPackages = fs->ReadInt32();
+    packages.reserve(numPackages);
+    for (int i = 0; i < numPackages; i++)
+    {
+        int len = fs->ReadInt32();
+        QString pkgPath;
+        fs->ReadStringASCII(pkgPath, len);
+        pkgPath.replace(QChar('\\'), QChar('/'));
+        packages.push_back(pkgPath);
+    }
+    return packages;
+}
+
+TextureMapEntry TextureMapFile::ReadTexture(int index)
+{
+    TextureMapEntry texture{};
+    if (fs == nullptr || index < 0 || index >= texturesCount)
+        return texture;
+
+    if (version == textureMapBinVersionNoIndex)
+        ScanTextureOffsets();
+    fs->JumpTo(textureOffsets[index]);
+    ReadTextureEntry(texture);
+    return texture;
+}
+
+void TextureMapFile::ReadTextures(QList<TextureMapEntry> &textures)
+{
+    if (fs == nullptr)
+        return;
+
+    // Records are stored one after another, no need to go through the index
+    bool noIndex = version == textureMapBinVersionNoIndex;
+    if (noIndex)
+        textureOffsets.resize(texturesCount);
+    textures.reserve(textures.count() + texturesCount);
+    fs->JumpTo(texturesOffset);
+    for (int i = 0; i < texturesCount; i++)
+    {
+        if (noIndex)
+            textureOffsets[i] = fs->Position();
+        TextureMapEntry texture{};
+        ReadTextureEntry(texture);
+        textures.push_back(texture);
+    }
+    if (noIndex)
+        packagesOffset = fs->Position();
+}
+
+bool TextureMapFile::Save(const QString &path, const QList<TextureMapEntry> &textures,
+                          const QStringList &packages)
+{
+    MemoryStream mem(HeaderSize + textures.count() * 256 + packages.count() * 64);
+    mem.WriteUInt32(textureMapBinTag);
+    mem.WriteUInt32(textureMapBinVersion);
+    mem.WriteInt32(textures.count());
+    mem.WriteInt64(HeaderSize);
+    mem.WriteInt64(0); // textures index offset, set below
+    mem.WriteInt64(0); // packages offset, set below
+
+    QVector<qint64> offsets(textures.count());
+    for (int i = 0; i < textures.count(); i++)
+    {
+        const TextureMapEntry& texture = textures[i];
+        offsets[i] = mem.Position();
+        mem.WriteInt32(texture.name.length());
+        mem.WriteStringASCII(texture.name);
+        mem.WriteUInt32(texture.crc);
+        mem.WriteInt32(texture.list.count());
+        for (int k = 0; k < texture.list.count(); k++)
+        {
+            const TextureMapPackageEntry& m = texture.list[k];
+            mem.WriteInt32(m.exportID);
+            mem.WriteInt32(m.movieTexture ? -2 : m.linkToMaster);
+            mem.WriteInt32(m.path.length());
+            QString pkgPath = m.path;
+            mem.WriteStringASCII(pkgPath.replace(QChar('/'), QChar('\\')));
+        }
+    }
+
+    qint64 texturesIndexOffset = mem.Position();
+    mem.WriteFromBuffer(reinterpret_cast<quint8 *>(offsets.data()),
+                        offsets.count() * static_cast<qint64>(sizeof(qint64)));
+
+    qint64 packagesSectionOffset = mem.Position();
+    mem.WriteInt32(packages.count());
+    for (int i = 0; i < packages.count(); i++)
+    {
+        QString pkgPath = packages[i];
+        mem.WriteInt32(pkgPath.length());
+        mem.WriteStringASCII(pkgPath.replace(QChar('/'), QChar('\\')));
+    }
+
+    mem.JumpTo(HeaderSize - 16);
+    mem.WriteInt64(texturesIndexOffset);
+    mem.WriteInt64(packagesSectionOffset);
+
+    // Written to a temporary file and renamed on commit, the previous map
+    // stays in place when writing fails.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        PERROR("Failed to write textures map: " + path + "\n");
+        return false;
+    }
+    ByteBuffer buffer = mem.ToArray();
+    file.write(reinterpret_cast<const char *>(buffer.ptr()), buffer.size());
+    buffer.Free();
+    if (!file.commit())
+    {
+        PERROR("Failed to write textures map: " + path + "\n");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEXTURE_MAP_FILE_H
+#define TEXTURE_MAP_FILE_H
+
+#include <Helpers/FileStream.h>
+#include <Texture/TextureScan.h>
+
+#include <QVector>
+
+// User textures scan file (me<id>map.bin).
+// Since version 3 the file starts with a table of sections:
+//   tag, version, textures count,
+//   offset of textures, offset of textures index, offset of packages
+// Textures index holds offset of each texture record, so the package list
+// and any single texture can be read without parsing the textures before it.
+// Version 2 files without the table are still readable and converted on load.
+class TextureMapFile
+{
+private:
+
+    FileStream *fs = nullptr;
+    uint version = 0;
+    int texturesCount = 0;
+    qint64 texturesOffset = 0;
+    qint64 packagesOffset = 0;
+    QVector<qint64> textureOffsets;
+
+    void ScanTextureOffsets();
+    void ReadTextureEntry(TextureMapEntry &texture);
+
+public:
+
+    enum
+    {
+        HeaderSize = 36,
+    };
+
+    TextureMapFile() = default;
+    TextureMapFile(const TextureMapFile &) = delete;
+    TextureMapFile &operator=(const TextureMapFile &) = delete;
+    ~TextureMapFile() { Close(); }
+
+    bool Open(const QString &path);
+    void Close();
+    uint Version() const { return version; }
+    bool NeedsMigration() const { return version != textureMapBinVersion; }
+    int TexturesCount() const { return texturesCount; }
+    QStringList ReadPackages();
+    TextureMapEntry ReadTexture(int index);
+    void ReadTextures(QList<TextureMapEntry> &textures);
+
+    static bool Save(const QString &path, const QList<TextureMapEntry> &textures,
+                     const QStringList &packages);
+};
+
+#endif
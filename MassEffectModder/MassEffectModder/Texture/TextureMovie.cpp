@@ -29,14 +29,21 @@
 #include <Types/MemTypes.h>
 
 TextureMovie::TextureMovie(Package &package, int exportId, const ByteBuffer &data)
+    : TextureMovie(package, exportId, ByteBuffer(data.ptr(), data.size()))
 {
+}
+
+TextureMovie::TextureMovie(Package &package, int exportId, ByteBuffer &&data)
+{
+    exportData = data;
     dataExportId = exportId;
     packagePath = package.packagePath;
-    properties = new TextureProperty(package, data);
-    if (data.size() == properties->propertyEndOffset)
+    properties = new TextureProperty(package, exportData);
+    if (exportData.size() == properties->propertyEndOffset)
         return;
 
-    textureData = new MemoryStream(data, properties->propertyEndOffset, data.size() - properties->propertyEndOffset);
+    textureData = new SpanStream(exportData, properties->propertyEndOffset,
+                                 exportData.size() - properties->propertyEndOffset);
 
     if (GameData::gameType != MeType::ME3_TYPE)
     {
@@ -71,6 +78,7 @@ void TextureMovie::replaceMovieData(ByteBuffer newData, uint offset)
     uncompressedSize = newData.size();
 
     delete textureData;
+    exportData.Free();
     textureData = new MemoryStream();
     if (GameData::gameType != MeType::ME3_TYPE)
     {
@@ -212,14 +220,14 @@ const ByteBuffer TextureMovie::getData()
 uint TextureMovie::getCrcData()
 {
     ByteBuffer data = getData();
-    uint crc = ~crc32_16bytes_prefetch(data.ptr(), data.size());
+    uint crc = ~crc32_parallel(data.ptr(), data.size());
     data.Free();
     return crc;
 }
 
 const ByteBuffer TextureMovie::toArray()
 {
-    MemoryStream newData;
+    MemoryStream newData(32 + (storageType == StorageTypes::pccUnc ? uncompressedSize : 0));
     if (GameData::gameType != MeType::ME3_TYPE)
     {
         newData.WriteZeros(16);
@@ -249,5 +257,6 @@ const ByteBuffer TextureMovie::toArray()
 TextureMovie::~TextureMovie()
 {
     delete textureData;
+    exportData.Free();
     delete properties;
 }
@@ -24,6 +24,7 @@
 
 #include <Helpers/FileStream.h>
 #include <Helpers/MemoryStream.h>
+#include <Helpers/SpanStream.h>
 #include <GameData/Package.h>
 #include <Texture/TextureProperty.h>
 
@@ -31,7 +32,8 @@ class TextureMovie
 {
 private:
 
-    MemoryStream *textureData = nullptr;
+    ByteBuffer exportData;
+    Stream *textureData = nullptr;
     QString packagePath;
     TextureProperty *properties;
     int dataExportId;
@@ -43,6 +45,8 @@ private:
 public:
 
     TextureMovie(Package &package, int exportId, const ByteBuffer &data);
+    // Takes ownership of data, texture reads it in place and frees it on destruction.
+    TextureMovie(Package &package, int exportId, ByteBuffer &&data);
     ~TextureMovie();
     TextureProperty& getProperties() { return *properties; }
     StorageTypes getStorageType() { return storageType; }
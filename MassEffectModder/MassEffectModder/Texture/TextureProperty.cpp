@@ -596,7 +596,10 @@ void TextureProperty::setStructValue(const QString &name, const QString &valueNa
 
 ByteBuffer TextureProperty::toArray()
 {
-    MemoryStream mem;
+    qint64 size = 4;
+    for (int i = 0; i < texPropertyList.count(); i++)
+        size += 24 + texPropertyList[i].valueRaw.size();
+    MemoryStream mem(size);
     mem.WriteUInt32(headerData);
     for (int i = 0; i < texPropertyList.count(); i++)
     {
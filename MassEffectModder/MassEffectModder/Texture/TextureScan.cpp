@@ -20,9 +20,13 @@
  */
 
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/IoPolicy.h>
 #include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/Trace.h>
 #include <Wrappers.h>
 #include <Texture/TextureScan.h>
+#include <Texture/TextureMapFile.h>
 #include <Texture/Texture.h>
 #include <Texture/TextureMovie.h>
 #include <GameData/Package.h>
@@ -36,6 +40,15 @@
 
 static bool generateBuiltinMapFiles = false; // change to true to enable map files generation
 
+// Hint OS to read packages ahead of the serial scan,
+// so storage handling parallel requests is kept busy.
+static void PrefetchPackages(const QStringList &packages, int index)
+{
+    int depth = IoPolicy::PrefetchDepth();
+    for (int i = (index == 0 ? 1 : index + depth); i <= index + depth && i < packages.count(); i++)
+        IoPolicy::Prefetch(g_GameData->GamePath() + packages[i]);
+}
+
 void TreeScan::loadTexturesMap(MeType gameId, Resources &resources, QList<TextureMapEntry> &textures)
 {
     QStringList pkgs;
@@ -119,10 +132,8 @@ bool TreeScan::loadTexturesMapFile(QString &path, QList<TextureMapEntry> &textur
     bool foundRemoved = false;
     bool foundAdded = false;
 
-    FileStream fs = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
-    uint tag = fs.ReadUInt32();
-    uint version = fs.ReadUInt32();
-    if (tag != textureMapBinTag || version != textureMapBinVersion)
+    TextureMapFile mapFile;
+    if (!mapFile.Open(path))
     {
         if (g_ipc)
         {
@@ -136,98 +147,50 @@ bool TreeScan::loadTexturesMapFile(QString &path, QList<TextureMapEntry> &textur
         return false;
     }
 
-    uint countTexture = fs.ReadUInt32();
-    for (uint i = 0; i < countTexture; i++)
+    QList<TextureMapEntry> mapTextures;
+    mapFile.ReadTextures(mapTextures);
+    QStringList packages = mapFile.ReadPackages();
+    if (mapFile.NeedsMigration())
     {
-        TextureMapEntry texture{};
-        int len = fs.ReadInt32();
-        fs.ReadStringASCII(texture.name, len);
-        texture.crc = fs.ReadUInt32();
-        uint countPackages = fs.ReadUInt32();
-        texture.list = QList<TextureMapPackageEntry>();
-        for (uint k = 0; k < countPackages; k++)
-        {
-            TextureMapPackageEntry matched{};
-            matched.exportID = fs.ReadInt32();
-            matched.linkToMaster = fs.ReadInt32();
-            if (matched.linkToMaster == -2)
-            {
-                matched.linkToMaster = -1;
-                matched.movieTexture = true;
-            }
-            len = fs.ReadInt32();
-            fs.ReadStringASCII(matched.path, len);
-            matched.path.replace(QChar('\\'), QChar('/'));
-            texture.list.push_back(matched);
-        }
-        textures.push_back(texture);
-    }
-
-    QStringList packages = QStringList();
-    int numPackages = fs.ReadInt32();
-    for (int i = 0; i < numPackages; i++)
-    {
-        int len = fs.ReadInt32();
-        QString pkgPath;
-        fs.ReadStringASCII(pkgPath, len);
-        pkgPath.replace(QChar('\\'), QChar('/'));
-        packages.push_back(pkgPath);
+        mapFile.Close();
+        // On failure the old map file is left untouched and migrated next time
+        if (!TextureMapFile::Save(path, mapTextures, packages))
+            PINFO("Textures map file kept in old version: " + path + "\n");
     }
+    textures += mapTextures;
 
     if (!ignoreCheck)
     {
-        for (int i = 0; i < packages.count(); i++)
+        QStringList addedFiles, removedFiles;
+        PathSet(packages).Diff(g_GameData->packageFilesSet, addedFiles, removedFiles);
+        foreach (const QString &file, removedFiles)
         {
-            bool found = false;
-            for (int s = 0; s < g_GameData->packageFiles.count(); s++)
+            if (g_ipc)
             {
-                if (AsciiStringMatchCaseIgnore(g_GameData->packageFiles[s], packages[i]))
-                {
-                    found = true;
-                    break;
-                }
+                ConsoleWrite(QString("[IPC]ERROR_REMOVED_FILE ") + file);
+                ConsoleSync();
             }
-            if (!found)
+            else
             {
-                if (g_ipc)
-                {
-                    ConsoleWrite(QString("[IPC]ERROR_REMOVED_FILE ") + packages[i]);
-                    ConsoleSync();
-                }
-                else
-                {
-                    PERROR(QString("Removed file since last game data scan: ") + packages[i] + "\n");
-                }
-                foundRemoved = true;
+                PERROR(QString("Removed file since last game data scan: ") + file + "\n");
             }
+            foundRemoved = true;
         }
         if (!g_ipc && foundRemoved)
             PERROR("Above files removed since last game data scan.\n");
 
-        for (int i = 0; i < g_GameData->packageFiles.count(); i++)
+        foreach (const QString &file, addedFiles)
         {
-            bool found = false;
-            for (int s = 0; s < packages.count(); s++)
+            if (g_ipc)
             {
-                if (AsciiStringMatchCaseIgnore(packages[s], g_GameData->packageFiles[i]))
-                {
-                    found = true;
-                    break;
-                }
+                ConsoleWrite(QString("[IPC]ERROR_ADDED_FILE ") + file);
+                ConsoleSync();
             }
-            if (!found)
+            else
             {
-                if (g_ipc)
-                {
-                    ConsoleWrite(QString("[IPC]ERROR_ADDED_FILE ") + g_GameData->packageFiles[i]);
-                    ConsoleSync();
-                }
-                else
-                {
-                    PERROR(QString("File: ") + g_GameData->packageFiles[i] + "\n");
-                }
-                foundAdded = true;
+                PERROR(QString("File: ") + file + "\n");
             }
+            foundAdded = true;
         }
         if (!g_ipc && foundAdded)
             PERROR("Above files added since last game data scan.\n");
@@ -439,6 +402,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                     callback(callbackHandle, newProgress, "Scanning textures");
                 }
             }
+            PrefetchPackages(modifiedFiles, i);
             FindTextures(gameId, textures, modifiedFiles[i], true);
         }
 
@@ -477,6 +441,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                     callback(callbackHandle, newProgress, "Scanning textures");
                 }
             }
+            PrefetchPackages(addedFiles, i);
             FindTextures(gameId, textures, addedFiles[i], false);
         }
     }
@@ -518,6 +483,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                     callback(callbackHandle, newProgress, "Scanning textures");
                 }
             }
+            PrefetchPackages(g_GameData->packageFiles, i);
             FindTextures(gameId, textures, g_GameData->packageFiles[i], false);
         }
     }
@@ -693,7 +659,11 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
         }
     }
 
-    if (saveMapFile)
+    if (saveMapFile && !generateBuiltinMapFiles)
+    {
+        TextureMapFile::Save(filename, textures, g_GameData->packageFiles);
+    }
+    else if (saveMapFile)
     {
         if (QFile(filename).exists())
             QFile(filename).remove();
@@ -701,85 +671,49 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
         auto fs = FileStream(filename, FileMode::Create, FileAccess::WriteOnly);
         MemoryStream mem;
         mem.WriteUInt32(textureMapBinTag);
-        mem.WriteUInt32(textureMapBinVersion);
+        mem.WriteUInt32(textureMapBinBuiltinVersion);
         mem.WriteInt32(textures.count());
 
         for (int i = 0; i < textures.count(); i++)
         {
             const TextureMapEntry& texture = textures[i];
-            if (generateBuiltinMapFiles)
-                mem.WriteByte(texture.name.length());
-            else
-                mem.WriteInt32(texture.name.length());
+            mem.WriteByte(texture.name.length());
             mem.WriteStringASCII(texture.name);
             mem.WriteUInt32(texture.crc);
-            if (generateBuiltinMapFiles)
-            {
-                mem.WriteInt16(texture.width);
-                mem.WriteInt16(texture.height);
-                mem.WriteByte(texture.pixfmt);
-                mem.WriteByte(texture.flags);
+            mem.WriteInt16(texture.width);
+            mem.WriteInt16(texture.height);
+            mem.WriteByte(texture.pixfmt);
+            mem.WriteByte(texture.flags);
 
-                mem.WriteInt16(texture.list.count());
-            }
-            else
-            {
-                mem.WriteInt32(texture.list.count());
-            }
+            mem.WriteInt16(texture.list.count());
             for (int k = 0; k < texture.list.count(); k++)
             {
                 const TextureMapPackageEntry& m = texture.list[k];
                 mem.WriteInt32(m.exportID);
-                if (generateBuiltinMapFiles)
-                {
-                    if (GameData::gameType == MeType::ME1_TYPE)
-                    {
-                        mem.WriteInt16(m.linkToMaster);
-                        if (m.linkToMaster != -1)
-                            mem.WriteStringASCIINull(m.basePackageName);
-                        mem.WriteUInt32(m.mipmapOffset);
-                    }
-                    mem.WriteByte(m.removeEmptyMips ? 1 : 0);
-                    mem.WriteByte(m.numMips);
-                    mem.WriteInt16(pkgs.indexOf(m.path));
-                }
-                else
+                if (GameData::gameType == MeType::ME1_TYPE)
                 {
-                    mem.WriteInt32(m.movieTexture ? -2 : m.linkToMaster);
-                    mem.WriteInt32(m.path.length());
-                    QString path = m.path;
-                    mem.WriteStringASCII(path.replace(QChar('/'), QChar('\\'), Qt::CaseInsensitive));
+                    mem.WriteInt16(m.linkToMaster);
+                    if (m.linkToMaster != -1)
+                        mem.WriteStringASCIINull(m.basePackageName);
+                    mem.WriteUInt32(m.mipmapOffset);
                 }
-            }
-        }
-        if (!generateBuiltinMapFiles)
-        {
-            mem.WriteInt32(g_GameData->packageFiles.count());
-            for (int i = 0; i < g_GameData->packageFiles.count(); i++)
-            {
-                mem.WriteInt32(g_GameData->packageFiles[i].length());
-                mem.WriteStringASCII(g_GameData->packageFiles[i].replace(QChar('/'), QChar('\\')));
+                mem.WriteByte(m.removeEmptyMips ? 1 : 0);
+                mem.WriteByte(m.numMips);
+                mem.WriteInt16(pkgs.indexOf(m.path));
             }
         }
         mem.SeekBegin();
 
-        if (generateBuiltinMapFiles)
-        {
-            fs.WriteUInt32(0x504D5443);
-            fs.WriteUInt32(mem.Length());
-            quint8 *compressed = nullptr;
-            uint compressedSize = 0;
-            ByteBuffer decompressed = mem.ToArray();
-            LzmaCompress(decompressed.ptr(), decompressed.size(), &compressed, &compressedSize, 9);
-            decompressed.Free();
-            fs.WriteUInt32(compressedSize);
-            fs.WriteFromBuffer(compressed, compressedSize);
-            delete[] compressed;
-        }
-        else
-        {
-            fs.CopyFrom(mem, mem.Length());
-        }
+        fs.WriteUInt32(0x504D5443);
+        fs.WriteUInt32(mem.Length());
+        quint8 *compressed = nullptr;
+        uint compressedSize = 0;
+        ByteBuffer decompressed = mem.ToArray();
+        LzmaCompress(decompressed.ptr(), decompressed.size(), &compressed, &compressedSize, 9);
+        decompressed.Free();
+        fs.WriteUInt32(compressedSize);
+        fs.WriteFromBuffer(compressed, compressedSize);
+        delete[] compressed;
     }
 
     if (removeEmptyMips)
@@ -804,6 +738,9 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
 void TreeScan::FindTextures(MeType gameId, QList<TextureMapEntry> &textures, const QString &packagePath,
                             bool modified)
 {
+    TRACE_SCOPE("TreeScan::FindTextures", "scan");
+    MetricsTimer packageTimer(Metrics::PackageTime);
+    IoPolicy::ThrottleFile(g_GameData->GamePath() + packagePath);
     Package package;
     int status = package.Open(g_GameData->GamePath() + packagePath);
     if (status != 0)
@@ -859,8 +796,7 @@ void TreeScan::FindTextures(MeType gameId, QList<TextureMapEntry> &textures, con
 
             if (id == package.nameIdTextureMovie)
             {
-                textureMovie = new TextureMovie(package, i, exportData);
-                exportData.Free();
+                textureMovie = new TextureMovie(package, i, std::move(exportData));
                 if (!textureMovie->hasTextureData())
                 {
                     delete textureMovie;
@@ -873,8 +809,7 @@ void TreeScan::FindTextures(MeType gameId, QList<TextureMapEntry> &textures, con
             }
             else
             {
-                texture = new Texture(package, i, exportData);
-                exportData.Free();
+                texture = new Texture(package, i, std::move(exportData));
                 if (!texture->hasImageData())
                 {
                     delete texture;
@@ -43,15 +43,19 @@ typedef enum
 } ImageFormat;
 
 #define textureMapBinTag      0x5054454D
-#define textureMapBinVersion  2
+#define textureMapBinVersion  3
+#define textureMapBinVersionNoIndex 2 // without sections table, converted on load
+#define textureMapBinBuiltinVersion 2 // builtin maps keep previous layout
 #define TextureModTag         0x444F4D54
 #define TextureModVersion     2
+#define TextureModVersionZstd 3 // may contain zstd compressed entries
 #define FileTextureTag        0x53444446
 #define FileTextureTag2       0x53444443
 #define FileMovieTextureTag   0x53494246
 #define FileBinaryTag         0x4E494246
 #define FileXdeltaTag         0x4E494258
 #define MEMI_TAG              0x494D454D
+#define DataZstdTag           0x4454535A // 'ZSTD'
 #define MEMendFileMarker      "ThisIsMEMEndOfFileMarker"
 #define MEMMarkerLength       (sizeof(MEMendFileMarker) - 1)
 
@@ -27,6 +27,9 @@
 #include <utility>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 
 #include <QtGlobal>
 #include <QCommandLineOption>
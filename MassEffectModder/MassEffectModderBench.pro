@@ -0,0 +1,30 @@
+TEMPLATE = subdirs
+
+CONFIG += ordered
+
+SUBDIRS += \
+    Libs/7z \
+    Libs/bfd \
+    Libs/dxtc \
+    Libs/lzo2
+
+!win32 {
+SUBDIRS += Libs/omp
+}
+
+SUBDIRS += \
+    Libs/png \
+    Libs/xdelta3 \
+    Libs/zlib \
+    Libs/zstd
+
+SUBDIRS += \
+    Libs/unrar \
+    Wrappers \
+    MassEffectModderBench
+
+ZSTD_ENABLE = true
+cache(ZSTD_ENABLE, set)
+
+TRACE_ENABLE = true
+cache(TRACE_ENABLE, set)
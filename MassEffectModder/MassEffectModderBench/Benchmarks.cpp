@@ -0,0 +1,351 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <QJsonDocument>
+
+#include "Benchmarks.h"
+#include <GameData/GameData.h>
+#include <GameData/Package.h>
+#include <Helpers/FileStream.h>
+#include <Helpers/Logs.h>
+#include <Helpers/Metrics.h>
+#include <Helpers/MiscHelpers.h>
+#include <Image/Image.h>
+#include <MipMaps/MipMaps.h>
+#include <Misc/Misc.h>
+#include <Resources/Resources.h>
+
+static QString GameName(MeType gameId)
+{
+    switch (gameId)
+    {
+        case MeType::ME1_TYPE:
+            return "ME1";
+        case MeType::ME2_TYPE:
+            return "ME2";
+        case MeType::ME3_TYPE:
+            return "ME3";
+        default:
+            return "";
+    }
+}
+
+static qint64 PackagesSize()
+{
+    qint64 size = 0;
+    foreach (QString file, g_GameData->packageFiles)
+        size += QFile(g_GameData->GamePath() + file).size();
+    return size;
+}
+
+QJsonObject BenchSuite::Run(const QString &name, MeType gameId, const BenchBody &body,
+                            const BenchSetup &setup)
+{
+    PINFO(QString("Benchmark: ") + name + (gameId != MeType::UNKNOWN_TYPE ? " " + GameName(gameId) : "") + "\n");
+
+    QJsonObject result;
+    result["name"] = name;
+    if (gameId != MeType::UNKNOWN_TYPE)
+        result["game"] = GameName(gameId);
+    result["iterations"] = config.iterations;
+
+    qint64 bytes = 0, items = 0;
+    qint64 best = -1, total = 0;
+    bool status = true;
+    Metrics::Reset();
+    for (int i = 0; i < config.iterations && status; i++)
+    {
+        if (setup && !setup())
+        {
+            status = false;
+            break;
+        }
+        bytes = items = 0;
+        QElapsedTimer timer;
+        timer.start();
+        status = body(bytes, items);
+        qint64 elapsed = timer.nsecsElapsed();
+        total += elapsed;
+        if (best == -1 || elapsed < best)
+            best = elapsed;
+    }
+    result["status"] = status ? "ok" : "failed";
+    if (!status)
+    {
+        PERROR(QString("Benchmark failed: ") + name + "\n");
+        return result;
+    }
+
+    double bestMs = best / 1000000.0;
+    result["bestMs"] = bestMs;
+    result["meanMs"] = total / 1000000.0 / config.iterations;
+    result["bytes"] = bytes;
+    result["items"] = items;
+    result["mbPerSec"] = bestMs > 0 ? (bytes / (1024.0 * 1024.0)) / (bestMs / 1000.0) : 0.0;
+    result["metrics"] = QJsonDocument::fromJson(Metrics::SummaryJson().toUtf8()).object();
+
+    return result;
+}
+
+bool BenchSuite::Regenerate(MeType gameId, bool decompressed)
+{
+    if (!BenchGenerator::GeneratePackages(config, gameId))
+        return false;
+    if (!decompressed || gameId == MeType::ME1_TYPE)
+        return true;
+    foreach (QString file, g_GameData->packageFiles)
+    {
+        Package package;
+        if (package.Open(g_GameData->GamePath() + file) != 0)
+            return false;
+        if (!package.SaveToFile(false, true, false))
+            return false;
+    }
+    return true;
+}
+
+bool BenchSuite::DecodeMem(const QString &path, qint64 &bytes, qint64 &items)
+{
+    FileStream fs = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+    if (!Misc::CheckMEMHeader(fs, path))
+        return false;
+    fs.JumpTo(fs.ReadInt64());
+    fs.SkipInt32();
+    int numFiles = fs.ReadInt32();
+    QList<FileMod> modFiles;
+    for (int i = 0; i < numFiles; i++)
+    {
+        FileMod fileMod{};
+        fileMod.tag = fs.ReadUInt32();
+        fs.ReadStringASCIINull(fileMod.name);
+        fileMod.offset = fs.ReadInt64();
+        fileMod.size = fs.ReadInt64();
+        modFiles.push_back(fileMod);
+    }
+    for (int i = 0; i < modFiles.count(); i++)
+    {
+        QString name;
+        fs.JumpTo(modFiles[i].offset);
+        fs.ReadStringASCIINull(name);
+        fs.SkipInt32();
+        ByteBuffer data = Misc::decompressData(fs, modFiles[i].size);
+        if (data.size() == 0)
+            return false;
+        bytes += data.size();
+        items++;
+        data.Free();
+    }
+    return true;
+}
+
+QJsonArray BenchSuite::RunImageBenchmarks()
+{
+    QJsonArray results;
+    int size = config.textureSize;
+    const PixelFormat formats[] = { PixelFormat::DXT1, PixelFormat::DXT5 };
+
+    for (PixelFormat format : formats)
+    {
+        QString formatName = format == PixelFormat::DXT1 ? "dxt1" : "dxt5";
+        results.append(Run("dxt_encode_" + formatName, MeType::UNKNOWN_TYPE,
+            [&](qint64 &bytes, qint64 &items)
+        {
+            ByteBuffer pixels = BenchGenerator::GeneratePixels(size, size, 1);
+            QList<MipMap *> mipmaps;
+            mipmaps.push_back(new MipMap(pixels, size, size, PixelFormat::ARGB));
+            pixels.Free();
+            Image image(mipmaps, PixelFormat::ARGB);
+            image.correctMips(format);
+            foreach (MipMap *mipmap, image.getMipMaps())
+            {
+                bytes += mipmap->getOrigWidth() * mipmap->getOrigHeight() * 4;
+                items++;
+            }
+            return true;
+        }));
+
+        ByteBuffer pixels = BenchGenerator::GeneratePixels(size, size, 1);
+        QList<MipMap *> mipmaps;
+        mipmaps.push_back(new MipMap(pixels, size, size, PixelFormat::ARGB));
+        pixels.Free();
+        Image image(mipmaps, PixelFormat::ARGB);
+        image.correctMips(format);
+        results.append(Run("dxt_decode_" + formatName, MeType::UNKNOWN_TYPE,
+            [&](qint64 &bytes, qint64 &items)
+        {
+            foreach (MipMap *mipmap, image.getMipMaps())
+            {
+                ByteBuffer argb = Image::convertRawToARGB(mipmap->getRefData().ptr(),
+                                                          mipmap->getWidth(), mipmap->getHeight(),
+                                                          format);
+                bytes += argb.size();
+                items++;
+                argb.Free();
+            }
+            return true;
+        }));
+    }
+
+    return results;
+}
+
+QJsonArray BenchSuite::RunGameBenchmarks(MeType gameId, ConfigIni &configIni)
+{
+    QJsonArray results;
+
+    if (!BenchGenerator::SetupGame(config, gameId, configIni) ||
+        !BenchGenerator::GeneratePackages(config, gameId))
+    {
+        PERROR(QString("Failed to generate game data for ") + GameName(gameId) + "\n");
+        return results;
+    }
+    g_GameData->Init(gameId, configIni, true);
+    g_GameData->FullScanGame = true;
+
+    memZlibPath = config.workDir + "/" + GameName(gameId) + "_zlib.mem";
+    if (!BenchGenerator::GenerateMod(config, gameId, memZlibPath, false))
+    {
+        PERROR(QString("Failed to generate MEM mod for ") + GameName(gameId) + "\n");
+        return results;
+    }
+#if defined(ZSTD_ENABLE)
+    // zstd compressor is optional, without it only the zlib MEM is benchmarked
+    memZstdPath = config.workDir + "/" + GameName(gameId) + "_zstd.mem";
+    if (!BenchGenerator::GenerateMod(config, gameId, memZstdPath, true))
+    {
+        PERROR(QString("Failed to generate zstd MEM mod for ") + GameName(gameId) + "\n");
+        return results;
+    }
+#endif
+
+    results.append(Run("md5", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        QStringList files = g_GameData->packageFiles + g_GameData->tfcFiles;
+        foreach (QString file, files)
+        {
+            QString path = g_GameData->GamePath() + file;
+            Misc::calculateMD5(path);
+            bytes += QFile(path).size();
+            items++;
+        }
+        return true;
+    }));
+
+    results.append(Run("package_decode", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        foreach (QString file, g_GameData->packageFiles)
+        {
+            Package package;
+            if (package.Open(g_GameData->GamePath() + file) != 0)
+                return false;
+            for (int i = 0; i < package.exportsTable.count(); i++)
+            {
+                ByteBuffer data = package.getExportData(i);
+                if (data.ptr() == nullptr)
+                    return false;
+                bytes += data.size();
+                items++;
+                data.Free();
+            }
+        }
+        return true;
+    }));
+
+    results.append(Run("scan", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        Resources resources;
+        textures.clear();
+        if (!TreeScan::PrepareListOfTextures(gameId, resources, textures, false, false,
+                                             nullptr, nullptr))
+        {
+            return false;
+        }
+        bytes = PackagesSize();
+        items = textures.count();
+        return items != 0;
+    }));
+
+    results.append(Run("mem_decode_zlib", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        return DecodeMem(memZlibPath, bytes, items);
+    }));
+
+#if defined(ZSTD_ENABLE)
+    results.append(Run("mem_decode_zstd", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        return DecodeMem(memZstdPath, bytes, items);
+    }));
+#endif
+
+    if (gameId != MeType::ME1_TYPE)
+    {
+        results.append(Run("decompress", gameId, [&](qint64 &bytes, qint64 &items)
+        {
+            foreach (QString file, g_GameData->packageFiles)
+            {
+                Package package;
+                if (package.Open(g_GameData->GamePath() + file) != 0)
+                    return false;
+                if (!package.SaveToFile(false, true, false))
+                    return false;
+                items++;
+            }
+            bytes = PackagesSize();
+            return true;
+        }, [&]()
+        {
+            return Regenerate(gameId, false);
+        }));
+
+        results.append(Run("repack", gameId, [&](qint64 &bytes, qint64 &items)
+        {
+            QStringList pkgsToRepack = g_GameData->packageFiles;
+            Misc::RepackME23(gameId, false, pkgsToRepack, nullptr, nullptr);
+            bytes = PackagesSize();
+            items = pkgsToRepack.count();
+            return true;
+        }, [&]()
+        {
+            return Regenerate(gameId, true);
+        }));
+    }
+
+    results.append(Run("mem_install", gameId, [&](qint64 &bytes, qint64 &items)
+    {
+        QStringList memFiles;
+        memFiles.push_back(memZlibPath);
+        QStringList pkgsToRepack, pkgsToMarker;
+        MipMaps mipMaps;
+        if (!Misc::applyMods(memFiles, textures, pkgsToRepack, pkgsToMarker, mipMaps,
+                             false, false, false, false, -1, nullptr, nullptr))
+        {
+            return false;
+        }
+        bytes = QFile(memZlibPath).size();
+        items = pkgsToMarker.count();
+        return true;
+    }, [&]()
+    {
+        return Regenerate(gameId, false);
+    }));
+
+    return results;
+}
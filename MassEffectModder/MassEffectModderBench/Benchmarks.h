@@ -0,0 +1,62 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BENCH_BENCHMARKS_H
+#define BENCH_BENCHMARKS_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "Generator.h"
+#include <Texture/TextureScan.h>
+
+#include <functional>
+
+// Each benchmark runs its body config.iterations times and reports
+// the best and mean wall time with the metrics counters of all runs.
+class BenchSuite
+{
+public:
+
+    typedef std::function<bool(qint64 &bytes, qint64 &items)> BenchBody;
+    typedef std::function<bool()> BenchSetup;
+
+private:
+
+    const BenchConfig &config;
+    QList<TextureMapEntry> textures;
+    QString memZlibPath;
+    QString memZstdPath;
+
+    QJsonObject Run(const QString &name, MeType gameId, const BenchBody &body,
+                    const BenchSetup &setup = nullptr);
+    bool Regenerate(MeType gameId, bool decompressed);
+    bool DecodeMem(const QString &path, qint64 &bytes, qint64 &items);
+
+public:
+
+    explicit BenchSuite(const BenchConfig &benchConfig) : config(benchConfig) {}
+
+    QJsonArray RunImageBenchmarks();
+    QJsonArray RunGameBenchmarks(MeType gameId, ConfigIni &configIni);
+};
+
+#endif
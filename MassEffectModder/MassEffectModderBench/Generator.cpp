@@ -0,0 +1,545 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "Generator.h"
+#include <GameData/GameData.h>
+#include <GameData/Package.h>
+#include <Helpers/FileStream.h>
+#include <Helpers/Logs.h>
+#include <Helpers/MemoryStream.h>
+#include <Helpers/MiscHelpers.h>
+#include <Image/Image.h>
+#include <MipMaps/MipMaps.h>
+#include <Misc/Misc.h>
+#include <Texture/Texture.h>
+
+#define BENCH_TFC_NAME "Textures"
+
+static const quint8 benchTfcGuid[16] =
+{
+    0x4D, 0x45, 0x4D, 0x42, 0x45, 0x4E, 0x43, 0x48,
+    0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE
+};
+
+// All names used by the texture properties are stored upfront,
+// so the property writers never need to grow the names table.
+static const char *benchNames[] =
+{
+    "None", "Core", "Engine", "Package", "Class", "Texture2D",
+    "ByteProperty", "IntProperty", "NameProperty", "StructProperty",
+    "Format", "EPixelFormat", "PF_DXT1", "PF_DXT5",
+    "SizeX", "SizeY", "MipTailBaseIdx",
+    "LODGroup", "TextureGroup", "TEXTUREGROUP_World",
+    "TextureFileCacheName", "TFCFileGuid", "Guid", BENCH_TFC_NAME,
+};
+
+enum BenchNameIds
+{
+    NameNone = 0,
+    NameCore,
+    NameEngine,
+    NamePackage,
+    NameClass,
+    NameTexture2D,
+};
+
+// mips smaller than this stay uncompressed inside the package as in the game data
+#define BENCH_MIN_STREAMED_MIP 64
+
+struct BenchTexture
+{
+    Image *image;
+    QList<uint> tfcOffsets;
+    QList<int> tfcSizes;
+};
+
+QString BenchGenerator::GamePath(const BenchConfig &config, MeType gameId)
+{
+    return config.workDir + QString("/ME%1").arg((int)gameId);
+}
+
+PixelFormat BenchGenerator::TextureFormat(int index)
+{
+    return (index % 2) == 0 ? PixelFormat::DXT1 : PixelFormat::DXT5;
+}
+
+QString BenchGenerator::TextureName(int index)
+{
+    return QString().asprintf("BenchTex_%04d", index);
+}
+
+ByteBuffer BenchGenerator::GeneratePixels(int width, int height, uint seed)
+{
+    // smooth gradients with some noise, close enough to real textures
+    // for the DXT encoders and compressors to behave the same way
+    ByteBuffer pixels(4ULL * width * height);
+    uint random = seed * 2654435761U + 12345;
+    quint8 *ptr = pixels.ptr();
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            random = random * 1664525 + 1013904223;
+            int noise = (random >> 24) & 15;
+            *ptr++ = (quint8)((x * 255 / width + seed * 37 + noise) & 0xFF);
+            *ptr++ = (quint8)((y * 255 / height + seed * 61 + noise) & 0xFF);
+            *ptr++ = (quint8)(((x + y) * 127 / width + seed * 13 + noise) & 0xFF);
+            *ptr++ = (quint8)(255 - ((x ^ y) & 63));
+        }
+    }
+    return pixels;
+}
+
+bool BenchGenerator::SetupGame(const BenchConfig &config, MeType gameId, ConfigIni &configIni)
+{
+    QString gamePath = GamePath(config, gameId);
+    if (QDir(gamePath).exists())
+        QDir(gamePath).removeRecursively();
+
+    QString exePath;
+    switch (gameId)
+    {
+        case MeType::ME1_TYPE:
+            exePath = gamePath + "/Binaries/MassEffect.exe";
+            break;
+        case MeType::ME2_TYPE:
+            exePath = gamePath + "/Binaries/MassEffect2.exe";
+            break;
+        case MeType::ME3_TYPE:
+            exePath = gamePath + "/Binaries/Win32/MassEffect3.exe";
+            break;
+        case MeType::UNKNOWN_TYPE:
+            CRASH();
+    }
+    QDir().mkpath(DirName(exePath));
+    {
+        FileStream fs = FileStream(exePath, FileMode::Create, FileAccess::WriteOnly);
+        fs.WriteUInt32(0);
+    }
+
+    configIni.Write(QString("ME%1").arg((int)gameId), gamePath, "GameDataPath");
+    g_GameData->Init(gameId, configIni, true);
+    if (g_GameData->GamePath().length() == 0)
+    {
+        PERROR(QString("Failed to setup synthetic game in: ") + gamePath + "\n");
+        return false;
+    }
+    QDir().mkpath(g_GameData->MainData());
+
+    return true;
+}
+
+static void WriteRawPackage(const QString &path, MeType gameId, int exportsCount)
+{
+    uint version = Package::packageFileVersionME3;
+    uint headerSize = Package::packageHeaderSizeME3;
+    if (gameId == MeType::ME1_TYPE)
+    {
+        version = Package::packageFileVersionME1;
+        headerSize = Package::packageHeaderSizeME1;
+    }
+    else if (gameId == MeType::ME2_TYPE)
+    {
+        version = Package::packageFileVersionME2;
+        headerSize = Package::packageHeaderSizeME2;
+    }
+
+    QStringList names;
+    for (auto name : benchNames)
+        names += name;
+    int firstObjectNameId = names.count();
+    for (int i = 0; i < exportsCount; i++)
+        names += BenchGenerator::TextureName(i);
+
+    MemoryStream mem;
+    mem.WriteUInt32(Package::DataTag);
+    mem.WriteUInt16(version);
+    mem.WriteUInt16(0); // licensee version
+    mem.WriteUInt32(0); // end of tables - filled later
+    mem.WriteInt32(5);
+    mem.WriteStringASCIINull("None");
+    mem.WriteUInt32(0); // package flags - uncompressed
+    if (gameId == MeType::ME3_TYPE)
+        mem.WriteUInt32(0);
+    qint64 tablesOffset = mem.Position();
+    mem.WriteZeros(headerSize - tablesOffset);
+
+    mem.WriteUInt32(Package::CompressionType::None);
+    mem.WriteUInt32(0); // number of chunks
+    mem.WriteUInt32(0); // some tag
+    if (gameId == MeType::ME2_TYPE)
+        mem.WriteUInt32(0); // const 0
+    mem.WriteUInt32(0); // extra names
+
+    qint64 dependsOffset = mem.Position();
+    mem.WriteZeros(sizeof(qint32) * exportsCount);
+    qint64 guidsOffset = mem.Position();
+
+    qint64 namesOffset = mem.Position();
+    for (int i = 0; i < names.count(); i++)
+    {
+        if (gameId == MeType::ME3_TYPE)
+        {
+            mem.WriteInt32(-(names[i].length() + 1));
+            mem.WriteStringUnicode16Null(names[i]);
+        }
+        else
+        {
+            mem.WriteInt32(names[i].length() + 1);
+            mem.WriteStringASCIINull(names[i]);
+        }
+        if (gameId == MeType::ME1_TYPE)
+            mem.WriteUInt64(0x0007001000000000ULL);
+        if (gameId == MeType::ME2_TYPE)
+            mem.WriteUInt32(0xfffffff2);
+    }
+
+    // class lookups skip the last import, keep the texture class in the middle
+    qint64 importsOffset = mem.Position();
+    const int imports[3][4] =
+    {
+        // package, class, link, object name
+        { NameCore, NamePackage, 0, NameEngine },
+        { NameCore, NameClass, -1, NameTexture2D },
+        { NameCore, NamePackage, 0, NameCore },
+    };
+    for (auto import : imports)
+    {
+        mem.WriteInt32(import[0]);
+        mem.WriteInt32(0);
+        mem.WriteInt32(import[1]);
+        mem.WriteInt32(0);
+        mem.WriteInt32(import[2]);
+        mem.WriteInt32(import[3]);
+        mem.WriteInt32(0);
+    }
+
+    // placeholder export data: properties terminated by "None" and no mipmaps
+    uint placeholderSize = sizeof(uint) + 2 * sizeof(qint32) + sizeof(qint32);
+    if (gameId != MeType::ME3_TYPE)
+        placeholderSize += 16;
+    uint exportEntrySize = Package::ExportEntry::DataOffsetOffset + 4 + 4 + 4 + 16 + 4;
+    if (gameId != MeType::ME3_TYPE)
+        exportEntrySize += 4;
+    qint64 exportsOffset = mem.Position();
+    uint dataOffset = exportsOffset + exportEntrySize * exportsCount;
+    for (int i = 0; i < exportsCount; i++)
+    {
+        mem.WriteInt32(-2); // Texture2D class import
+        mem.WriteInt32(0); // super
+        mem.WriteInt32(0); // link
+        mem.WriteInt32(firstObjectNameId + i);
+        mem.WriteInt32(0); // suffix
+        mem.WriteInt32(0); // archetype
+        mem.WriteUInt64(0); // object flags
+        mem.WriteUInt32(placeholderSize);
+        mem.WriteUInt32(dataOffset + placeholderSize * i);
+        if (gameId != MeType::ME3_TYPE)
+            mem.WriteUInt32(0); // components
+        mem.WriteInt32(0); // export flags
+        mem.WriteUInt32(0); // net objects
+        mem.WriteZeros(16); // guid
+        mem.WriteInt32(0);
+    }
+    for (int i = 0; i < exportsCount; i++)
+    {
+        mem.WriteUInt32(0);
+        mem.WriteInt32(NameNone);
+        mem.WriteInt32(0);
+        if (gameId != MeType::ME3_TYPE)
+            mem.WriteZeros(16);
+        mem.WriteInt32(0); // number of mipmaps
+    }
+
+    mem.JumpTo(Package::packageHeaderFirstChunkSizeOffset);
+    mem.WriteUInt32(dataOffset);
+    mem.JumpTo(tablesOffset);
+    mem.WriteUInt32(names.count());
+    mem.WriteUInt32(namesOffset);
+    mem.WriteUInt32(exportsCount);
+    mem.WriteUInt32(exportsOffset);
+    mem.WriteUInt32(3);
+    mem.WriteUInt32(importsOffset);
+    mem.WriteUInt32(dependsOffset);
+    mem.WriteUInt32(guidsOffset);
+    mem.SeekBegin();
+
+    FileStream fs = FileStream(path, FileMode::Create, FileAccess::WriteOnly);
+    fs.CopyFrom(mem, mem.Length());
+}
+
+static bool FillTextures(const QString &path, MeType gameId, const QList<BenchTexture> &textures,
+                         Package::CompressionType compression)
+{
+    Package package;
+    if (package.Open(path) != 0)
+        return false;
+
+    ByteBuffer guid(benchTfcGuid, sizeof(benchTfcGuid));
+    for (int i = 0; i < package.exportsTable.count(); i++)
+    {
+        const BenchTexture &source = textures[i];
+        QList<MipMap *> &images = source.image->getMipMaps();
+        ByteBuffer exportData = package.getExportData(i);
+        Texture texture(package, i, exportData);
+        exportData.Free();
+
+        QList<Texture::TextureMipMap> mipmaps;
+        bool external = false;
+        for (int m = 0; m < images.count(); m++)
+        {
+            Texture::TextureMipMap mipmap;
+            mipmap.width = images[m]->getOrigWidth();
+            mipmap.height = images[m]->getOrigHeight();
+            const ByteBuffer &data = images[m]->getRefData();
+            mipmap.uncompressedSize = data.size();
+            if (mipmap.width < BENCH_MIN_STREAMED_MIP && mipmap.height < BENCH_MIN_STREAMED_MIP)
+            {
+                mipmap.storageType = StorageTypes::pccUnc;
+                mipmap.compressedSize = mipmap.uncompressedSize;
+                mipmap.newData = ByteBuffer(data.ptr(), data.size());
+                mipmap.freeNewData = true;
+            }
+            else if (gameId == MeType::ME1_TYPE)
+            {
+                mipmap.storageType = StorageTypes::pccLZO;
+                mipmap.newData = Package::compressData(data, mipmap.storageType);
+                mipmap.compressedSize = mipmap.newData.size();
+                mipmap.freeNewData = true;
+            }
+            else
+            {
+                mipmap.storageType = gameId == MeType::ME2_TYPE ? StorageTypes::extLZO : StorageTypes::extZlib;
+                mipmap.dataOffset = source.tfcOffsets[m];
+                mipmap.compressedSize = source.tfcSizes[m];
+                external = true;
+            }
+            mipmaps.push_back(mipmap);
+        }
+        texture.replaceMipMaps(mipmaps);
+
+        TextureProperty &properties = texture.getProperties();
+        properties.setByteValue("Format", Image::getEngineFormatType(source.image->getPixelFormat()), "EPixelFormat");
+        properties.setIntValue("SizeX", texture.mipMapsList.first().width);
+        properties.setIntValue("SizeY", texture.mipMapsList.first().height);
+        properties.setIntValue("MipTailBaseIdx", texture.mipMapsList.count() - 1);
+        properties.setByteValue("LODGroup", "TEXTUREGROUP_World", "TextureGroup");
+        if (external)
+        {
+            properties.setNameValue("TextureFileCacheName", BENCH_TFC_NAME);
+            properties.setStructValue("TFCFileGuid", "Guid", guid);
+        }
+
+        // same two pass update as texture replacing, offsets are known after first pass
+        ByteBuffer bufferProperties = properties.toArray();
+        {
+            MemoryStream newData;
+            newData.WriteFromBuffer(bufferProperties);
+            ByteBuffer bufferTextureData = texture.toArray(0, false);
+            newData.WriteFromBuffer(bufferTextureData);
+            bufferTextureData.Free();
+            ByteBuffer bufferTexture = newData.ToArray();
+            package.setExportData(i, bufferTexture);
+            bufferTexture.Free();
+        }
+        {
+            MemoryStream newData;
+            newData.WriteFromBuffer(bufferProperties);
+            uint packageDataOffset = package.exportsTable[i].getDataOffset() + (uint)newData.Position();
+            ByteBuffer bufferTextureData = texture.toArray(packageDataOffset);
+            newData.WriteFromBuffer(bufferTextureData);
+            bufferTextureData.Free();
+            ByteBuffer bufferTexture = newData.ToArray();
+            package.setExportData(i, bufferTexture);
+            bufferTexture.Free();
+        }
+        bufferProperties.Free();
+    }
+    guid.Free();
+
+    // package writer compresses only with zlib, LZO packages are made
+    // by saving the zlib one again with LZO as its compression type
+    package.SaveToFile(compression != Package::CompressionType::None, false, false);
+    if (compression != Package::CompressionType::LZO)
+        return true;
+
+    Package packageLZO;
+    if (packageLZO.Open(path) != 0)
+        return false;
+    for (int i = 0; i < packageLZO.exportsTable.count(); i++)
+    {
+        ByteBuffer data = packageLZO.getExportData(i);
+        packageLZO.setExportData(i, data);
+        data.Free();
+    }
+    packageLZO.compressionType = Package::CompressionType::LZO;
+    packageLZO.SaveToFile(false, false, false);
+
+    return true;
+}
+
+static Package::CompressionType PackageCompression(const BenchConfig &config, MeType gameId)
+{
+    if (gameId == MeType::ME1_TYPE)
+        return Package::CompressionType::None;
+    if (config.compression == "none")
+        return Package::CompressionType::None;
+    if (config.compression == "zlib")
+        return Package::CompressionType::Zlib;
+    if (config.compression == "lzo")
+        return Package::CompressionType::LZO;
+    return gameId == MeType::ME2_TYPE ? Package::CompressionType::LZO : Package::CompressionType::Zlib;
+}
+
+bool BenchGenerator::GeneratePackages(const BenchConfig &config, MeType gameId)
+{
+    QString mainData = g_GameData->MainData();
+    QString extension = gameId == MeType::ME1_TYPE ? ".upk" : ".pcc";
+    Package::CompressionType compression = PackageCompression(config, gameId);
+
+    // every package holds the same set of textures, like shared
+    // textures spread over many packages in the game data
+    QList<BenchTexture> textures;
+    std::unique_ptr<FileStream> tfc;
+    StorageTypes externalStorage = gameId == MeType::ME2_TYPE ? StorageTypes::extLZO : StorageTypes::extZlib;
+    if (gameId != MeType::ME1_TYPE)
+    {
+        tfc.reset(new FileStream(mainData + "/" + BENCH_TFC_NAME + ".tfc", FileMode::Create, FileAccess::WriteOnly));
+        tfc->WriteFromBuffer(const_cast<quint8 *>(benchTfcGuid), sizeof(benchTfcGuid));
+    }
+    for (int t = 0; t < config.exports; t++)
+    {
+        BenchTexture texture{};
+        ByteBuffer pixels = GeneratePixels(config.textureSize, config.textureSize, t);
+        QList<MipMap *> mipmaps;
+        mipmaps.push_back(new MipMap(pixels, config.textureSize, config.textureSize, PixelFormat::ARGB));
+        pixels.Free();
+        texture.image = new Image(mipmaps, PixelFormat::ARGB);
+        texture.image->correctMips(TextureFormat(t));
+        if (tfc)
+        {
+            foreach (MipMap *mipmap, texture.image->getMipMaps())
+            {
+                if (mipmap->getOrigWidth() < BENCH_MIN_STREAMED_MIP &&
+                    mipmap->getOrigHeight() < BENCH_MIN_STREAMED_MIP)
+                {
+                    texture.tfcOffsets.push_back(0);
+                    texture.tfcSizes.push_back(0);
+                    continue;
+                }
+                ByteBuffer data = Package::compressData(mipmap->getRefData(), externalStorage);
+                texture.tfcOffsets.push_back((uint)tfc->Position());
+                texture.tfcSizes.push_back(data.size());
+                tfc->WriteFromBuffer(data);
+                data.Free();
+            }
+        }
+        textures.push_back(texture);
+    }
+    tfc.reset();
+
+    bool status = true;
+    for (int p = 0; p < config.packages && status; p++)
+    {
+        QString path = mainData + QString().asprintf("/BenchPackage_%03d", p) + extension;
+        WriteRawPackage(path, gameId, config.exports);
+        status = FillTextures(path, gameId, textures, compression);
+    }
+
+    foreach (BenchTexture texture, textures)
+        delete texture.image;
+
+    return status;
+}
+
+bool BenchGenerator::GenerateMod(const BenchConfig &config, MeType gameId, const QString &memPath,
+                                 bool useZstd)
+{
+    if (g_GameData->packageFiles.count() == 0)
+        return false;
+
+    // half of the textures get replaced, in every package they are used
+    int modsCount = qMax(1, config.exports / 2);
+    QList<uint> crcs;
+    {
+        Package package;
+        if (package.Open(g_GameData->GamePath() + g_GameData->packageFiles.first()) != 0)
+            return false;
+        for (int i = 0; i < modsCount; i++)
+        {
+            ByteBuffer exportData = package.getExportData(i);
+            Texture texture(package, i, exportData);
+            exportData.Free();
+            uint crc = texture.getCrcTopMipmap();
+            if (crc == 0)
+                return false;
+            crcs.push_back(crc);
+        }
+    }
+
+    QList<FileMod> modFiles;
+    FileStream outFs = FileStream(memPath, FileMode::Create, FileAccess::WriteOnly);
+    outFs.WriteUInt32(TextureModTag);
+    outFs.WriteUInt32(useZstd ? TextureModVersionZstd : TextureModVersion);
+    outFs.WriteInt64(0); // filled later
+    for (int i = 0; i < modsCount; i++)
+    {
+        ByteBuffer pixels = GeneratePixels(config.textureSize, config.textureSize, 0x10000 + i);
+        QList<MipMap *> mipmaps;
+        mipmaps.push_back(new MipMap(pixels, config.textureSize, config.textureSize, PixelFormat::ARGB));
+        pixels.Free();
+        Image image(mipmaps, PixelFormat::ARGB);
+        image.correctMips(TextureFormat(i));
+        ByteBuffer dds = image.StoreImageToDDS();
+
+        FileMod fileMod{};
+        fileMod.tag = FileTextureTag;
+        fileMod.name = TextureName(i) + QString().asprintf("_0x%08X", crcs[i]) + ".dds";
+        fileMod.offset = outFs.Position();
+        outFs.WriteStringASCIINull(TextureName(i));
+        outFs.WriteUInt32(crcs[i]);
+        qint64 dataOffset = outFs.Position();
+        bool status = Misc::compressData(dds, outFs, useZstd);
+        dds.Free();
+        if (!status)
+            return false;
+        fileMod.size = outFs.Position() - dataOffset;
+        modFiles.push_back(fileMod);
+    }
+
+    qint64 pos = outFs.Position();
+    outFs.SeekBegin();
+    outFs.WriteUInt32(TextureModTag);
+    outFs.WriteUInt32(useZstd ? TextureModVersionZstd : TextureModVersion);
+    outFs.WriteInt64(pos);
+    outFs.JumpTo(pos);
+    outFs.WriteUInt32((uint)gameId);
+    outFs.WriteInt32(modFiles.count());
+    for (int i = 0; i < modFiles.count(); i++)
+    {
+        outFs.WriteUInt32(modFiles[i].tag);
+        outFs.WriteStringASCIINull(modFiles[i].name);
+        outFs.WriteInt64(modFiles[i].offset);
+        outFs.WriteInt64(modFiles[i].size);
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BENCH_GENERATOR_H
+#define BENCH_GENERATOR_H
+
+#include <Helpers/ByteBuffer.h>
+#include <Program/ConfigIni.h>
+#include <Types/MemTypes.h>
+
+struct BenchConfig
+{
+    QString workDir;
+    QList<MeType> games;
+    int packages = 8;
+    int exports = 16;
+    int textureSize = 512;
+    int iterations = 3;
+    QString compression; // empty means game default: ME2 LZO, ME3 zlib
+    bool keep = false;
+    bool verbose = false;
+};
+
+// Builds a synthetic game tree with the same writers the installer uses,
+// so the benchmarks run offline without any game data installed.
+class BenchGenerator
+{
+public:
+
+    static QString GamePath(const BenchConfig &config, MeType gameId);
+    static bool SetupGame(const BenchConfig &config, MeType gameId, ConfigIni &configIni);
+    static bool GeneratePackages(const BenchConfig &config, MeType gameId);
+    static bool GenerateMod(const BenchConfig &config, MeType gameId, const QString &memPath,
+                            bool useZstd);
+    static ByteBuffer GeneratePixels(int width, int height, uint seed);
+    static PixelFormat TextureFormat(int index);
+    static QString TextureName(int index);
+};
+
+#endif
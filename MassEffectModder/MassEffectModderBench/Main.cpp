@@ -0,0 +1,232 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2019 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <QJsonDocument>
+
+#include "Benchmarks.h"
+#include <GameData/GameData.h>
+#include <Helpers/FileStream.h>
+#include <Helpers/Logs.h>
+#include <Helpers/MiscHelpers.h>
+#include <Program/SignalHandler.h>
+
+bool g_ipc = false;
+
+static void PrintHelp()
+{
+    ConsoleWrite(QString("\nMassEffectModderBench v%1\n\n"
+        "Generates synthetic ME1/ME2/ME3 game data and benchmarks the main\n"
+        "code paths on it. Results are printed as JSON.\n\n"
+        "Options:\n"
+        "  --work-dir <path>        parent directory for generated data (default: temp dir),\n"
+        "                           data goes to own new subdirectory of it\n"
+        "  --games <list>           comma separated game ids, default: 1,2,3\n"
+        "  --packages <n>           number of packages per game, default: 8\n"
+        "  --exports <n>            number of textures per package, default: 16\n"
+        "  --texture-size <n>       texture width and height, default: 512\n"
+        "  --iterations <n>         runs of each benchmark, default: 3\n"
+        "  --compression <type>     package compression: zlib, lzo or none\n"
+        "                           default: LZO for ME2, zlib for ME3\n"
+        "  --output <file>          write JSON to file instead of console\n"
+        "  --keep                   keep generated data subdirectory\n"
+        "  --verbose                print progress\n").arg(MEM_VERSION));
+}
+
+static bool hasValue(const QStringList &args, int curPos)
+{
+    return args.count() >= (curPos + 2) && !args[curPos + 1].startsWith("--");
+}
+
+static bool ParseInt(const QStringList &args, int &l, int &value)
+{
+    if (!hasValue(args, l))
+        return false;
+    bool ok;
+    int v = args[++l].toInt(&ok);
+    if (!ok || v <= 0)
+        return false;
+    value = v;
+    return true;
+}
+
+static int ParseArguments(BenchConfig &config, QString &output)
+{
+    QStringList args = QCoreApplication::arguments();
+    if (args.count() != 0)
+        args.removeFirst();
+
+    for (int l = 0; l < args.count(); l++)
+    {
+        const QString arg = args[l].toLower();
+        bool status = true;
+        if (arg == "--help")
+        {
+            PrintHelp();
+            return 1;
+        }
+        else if (arg == "--work-dir" && hasValue(args, l))
+            config.workDir = args[++l].replace('\\', '/');
+        else if (arg == "--output" && hasValue(args, l))
+            output = args[++l].replace('\\', '/');
+        else if (arg == "--games" && hasValue(args, l))
+        {
+            config.games.clear();
+            foreach (QString game, args[++l].split(','))
+            {
+                int id = game.toInt(&status);
+                if (!status || id < 1 || id > 3)
+                {
+                    status = false;
+                    break;
+                }
+                config.games.push_back((MeType)id);
+            }
+        }
+        else if (arg == "--packages")
+            status = ParseInt(args, l, config.packages);
+        else if (arg == "--exports")
+            status = ParseInt(args, l, config.exports);
+        else if (arg == "--texture-size")
+        {
+            status = ParseInt(args, l, config.textureSize);
+            if (status && (config.textureSize & (config.textureSize - 1)) != 0)
+                status = false;
+        }
+        else if (arg == "--iterations")
+            status = ParseInt(args, l, config.iterations);
+        else if (arg == "--compression" && hasValue(args, l))
+        {
+            config.compression = args[++l].toLower();
+            status = config.compression == "zlib" || config.compression == "lzo" ||
+                     config.compression == "none";
+        }
+        else if (arg == "--keep")
+            config.keep = true;
+        else if (arg == "--verbose")
+            config.verbose = true;
+        else
+            status = false;
+
+        if (!status)
+        {
+            PERROR(QString("Wrong argument: ") + args[l] + "\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    InstallSignalsHandler();
+    CreateLogs();
+
+    QCoreApplication application(argc, argv);
+    QLocale::setDefault(QLocale(QLocale::English, QLocale::UnitedStates));
+    CreateGameData();
+
+    BenchConfig config;
+    config.workDir = QDir::tempPath();
+    config.games = { MeType::ME1_TYPE, MeType::ME2_TYPE, MeType::ME3_TYPE };
+    QString output;
+
+    g_logs->EnableOutputConsole(true);
+    g_logs->ChangeLogLevel(LOG_ERROR);
+    int status = ParseArguments(config, output);
+    if (status != 0)
+    {
+        ReleaseGameData();
+        ReleaseLogs();
+        return status > 0 ? 0 : 1;
+    }
+    if (config.verbose)
+        g_logs->ChangeLogLevel(LOG_INFO);
+
+    // Generated data goes to a new subdirectory, the directory given by
+    // user is never removed, only what the bench created in it.
+    QDir().mkpath(config.workDir);
+    QTemporaryDir workDir(config.workDir + "/MassEffectModderBench-XXXXXX");
+    if (!workDir.isValid())
+    {
+        PERROR("Failed to create work directory in: " + config.workDir + "\n");
+        ReleaseGameData();
+        ReleaseLogs();
+        return 1;
+    }
+    workDir.setAutoRemove(!config.keep);
+    config.workDir = workDir.path();
+    if (config.keep)
+        PINFO("Generated data is kept in: " + config.workDir + "\n");
+    ConfigIni configIni = ConfigIni(config.workDir + "/MassEffectModderBench.ini");
+
+    BenchSuite suite(config);
+    QJsonArray results = suite.RunImageBenchmarks();
+    foreach (MeType gameId, config.games)
+    {
+        QJsonArray gameResults = suite.RunGameBenchmarks(gameId, configIni);
+        if (gameResults.count() == 0)
+            status = 1;
+        foreach (const QJsonValue &result, gameResults)
+        {
+            if (result.toObject()["status"].toString() != "ok")
+                status = 1;
+            results.append(result);
+        }
+    }
+
+    QJsonArray games;
+    foreach (MeType gameId, config.games)
+        games.append((int)gameId);
+    QJsonObject configJson;
+    configJson["games"] = games;
+    configJson["packages"] = config.packages;
+    configJson["exports"] = config.exports;
+    configJson["textureSize"] = config.textureSize;
+    configJson["iterations"] = config.iterations;
+    configJson["compression"] = config.compression.isEmpty() ? "default" : config.compression;
+    configJson["threads"] = omp_get_max_threads();
+    if (config.keep)
+        configJson["workDir"] = config.workDir;
+
+    QJsonObject report;
+    report["benchmark"] = "MassEffectModderBench";
+    report["memVersion"] = MEM_VERSION;
+    report["config"] = configJson;
+    report["results"] = results;
+    report["peakMemoryBytes"] = static_cast<qint64>(DetectPeakMemoryUsage());
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (output.length() != 0)
+    {
+        FileStream fs = FileStream(output, FileMode::Create, FileAccess::WriteOnly);
+        fs.WriteFromBuffer(reinterpret_cast<quint8 *>(json.data()), json.size());
+    }
+    else
+    {
+        ConsoleWrite(QString::fromUtf8(json));
+    }
+
+    ReleaseGameData();
+    ReleaseLogs();
+
+    return status;
+}
@@ -0,0 +1,215 @@
+QT += core
+QT -= gui
+
+CONFIG += c++17 static precompile_header console
+CONFIG -= app_bundle
+CONFIG += sdk_no_version_check
+
+TARGET = MassEffectModderBench
+
+TEMPLATE = app
+
+SOURCES += \
+    ../MassEffectModder/GameData/DLC.cpp \
+    ../MassEffectModder/GameData/GameData.cpp \
+    ../MassEffectModder/GameData/LODSettings.cpp \
+    ../MassEffectModder/GameData/Package.cpp \
+    ../MassEffectModder/GameData/TOCFile.cpp \
+    ../MassEffectModder/Helpers/BufferPool.cpp \
+    ../MassEffectModder/Helpers/Crc32.cpp \
+    ../MassEffectModder/Helpers/FileHashCache.cpp \
+    ../MassEffectModder/Helpers/FileStream.cpp \
+    ../MassEffectModder/Helpers/FileStreamPool.cpp \
+    ../MassEffectModder/Helpers/IoPolicy.cpp \
+    ../MassEffectModder/Helpers/Logs.cpp \
+    ../MassEffectModder/Helpers/Metrics.cpp \
+    ../MassEffectModder/Helpers/MemoryStream.cpp \
+    ../MassEffectModder/Helpers/MiscHelpers.cpp \
+    ../MassEffectModder/Helpers/MmapStream.cpp \
+    ../MassEffectModder/Helpers/PathSet.cpp \
+    ../MassEffectModder/Helpers/SpanStream.cpp \
+    ../MassEffectModder/Helpers/Stream.cpp \
+    ../MassEffectModder/Helpers/TaskScheduler.cpp \
+    ../MassEffectModder/Helpers/Trace.cpp \
+    ../MassEffectModder/Image/Image.cpp \
+    ../MassEffectModder/Image/ImageBMP.cpp \
+    ../MassEffectModder/Image/ImageDDS.cpp \
+    ../MassEffectModder/Image/ImageTGA.cpp \
+    ../MassEffectModder/Md5/MD5BadEntries.cpp \
+    ../MassEffectModder/Md5/MD5ModEntries.cpp \
+    ../MassEffectModder/MipMaps/MipMap.cpp \
+    ../MassEffectModder/MipMaps/MipMapsEmptyMips.cpp \
+    ../MassEffectModder/MipMaps/MipMapsReplace.cpp \
+    ../MassEffectModder/Misc/Misc.cpp \
+    ../MassEffectModder/Misc/MiscCheckGame.cpp \
+    ../MassEffectModder/Misc/MiscMods.cpp \
+    ../MassEffectModder/Misc/MiscModsInstall.cpp \
+    ../MassEffectModder/Misc/MiscProcessGame.cpp \
+    ../MassEffectModder/Misc/MiscTexture.cpp \
+    ../MassEffectModder/Program/ConfigIni.cpp \
+    ../MassEffectModder/Program/SignalHandler.cpp \
+    ../MassEffectModder/Resources/Resources.cpp \
+    ../MassEffectModder/Texture/Texture.cpp \
+    ../MassEffectModder/Texture/TextureMapFile.cpp \
+    ../MassEffectModder/Texture/TextureMovie.cpp \
+    ../MassEffectModder/Texture/TextureProperty.cpp \
+    ../MassEffectModder/Texture/TextureScan.cpp \
+    Benchmarks.cpp \
+    Generator.cpp \
+    Main.cpp
+
+PRECOMPILED_HEADER = ../MassEffectModder/Types/Precompiled.h
+
+HEADERS += \
+    ../MassEffectModder/GameData/DLC.h \
+    ../MassEffectModder/GameData/GameData.h \
+    ../MassEffectModder/GameData/LODSettings.h \
+    ../MassEffectModder/GameData/Package.h \
+    ../MassEffectModder/GameData/TOCFile.h \
+    ../MassEffectModder/Helpers/BufferPool.h \
+    ../MassEffectModder/Helpers/ByteBuffer.h \
+    ../MassEffectModder/Helpers/BinarySearch.h \
+    ../MassEffectModder/Helpers/Crc32.h \
+    ../MassEffectModder/Helpers/Exception.h \
+    ../MassEffectModder/Helpers/FileHashCache.h \
+    ../MassEffectModder/Helpers/FileStream.h \
+    ../MassEffectModder/Helpers/FileStreamPool.h \
+    ../MassEffectModder/Helpers/IoPolicy.h \
+    ../MassEffectModder/Helpers/Logs.h \
+    ../MassEffectModder/Helpers/Metrics.h \
+    ../MassEffectModder/Helpers/MemoryStream.h \
+    ../MassEffectModder/Helpers/MiscHelpers.h \
+    ../MassEffectModder/Helpers/MmapStream.h \
+    ../MassEffectModder/Helpers/PathSet.h \
+    ../MassEffectModder/Helpers/SpanStream.h \
+    ../MassEffectModder/Helpers/QSort.h \
+    ../MassEffectModder/Helpers/ScratchBuffer.h \
+    ../MassEffectModder/Helpers/Stream.h \
+    ../MassEffectModder/Helpers/TaskScheduler.h \
+    ../MassEffectModder/Helpers/Trace.h \
+    ../MassEffectModder/Image/Image.h \
+    ../MassEffectModder/Md5/MD5BadEntries.h \
+    ../MassEffectModder/Md5/MD5ModEntries.h \
+    ../MassEffectModder/Misc/Misc.h \
+    ../MassEffectModder/MipMaps/MipMap.h \
+    ../MassEffectModder/MipMaps/MipMaps.h \
+    ../MassEffectModder/Program/ConfigIni.h \
+    ../MassEffectModder/Program/SignalHandler.h \
+    ../MassEffectModder/Resources/Resources.h \
+    ../MassEffectModder/Texture/Texture.h \
+    ../MassEffectModder/Texture/TextureMapFile.h \
+    ../MassEffectModder/Texture/TextureMovie.h \
+    ../MassEffectModder/Texture/TextureProperty.h \
+    ../MassEffectModder/Texture/TextureScan.h \
+    ../MassEffectModder/Types/MemTypes.h \
+    Benchmarks.h \
+    Generator.h
+
+include(../MassEffectModder/Program/Version.pri)
+
+DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += MEM_VERSION=\"$$VERSION\" MEM_YEAR=\"$$MEM_YEAR\"
+
+precompile_header:!isEmpty(PRECOMPILED_HEADER) {
+    DEFINES += USING_PCH
+}
+PRECOMPILED_DIR = ".pch"
+
+equals(ZSTD_ENABLE, true) {
+    DEFINES += ZSTD_ENABLE
+}
+
+equals(TRACE_ENABLE, true) {
+    DEFINES += TRACE_ENABLE
+}
+
+QMAKE_CXXFLAGS_RELEASE -= -O2
+equals(RELEASE_IN_DEBUG_MODE, true) {
+    QMAKE_CXXFLAGS_RELEASE += -g
+} else {
+    CONFIG(release, debug | release) {
+        DEFINES += NDEBUG
+        macx {
+            QMAKE_POST_LINK += dsymutil $$TARGET -o "$$TARGET".dSYM
+        }
+    }
+    QMAKE_CXXFLAGS_RELEASE += -g1 -O3
+}
+
+QMAKE_CXXFLAGS +=
+QMAKE_CXXFLAGS_DEBUG += -g
+
+win32-g++: {
+    # Disable compiler warning
+    QMAKE_CXXFLAGS += -Wno-deprecated-copy
+    QMAKE_LFLAGS_RELEASE = "-Wl,--relax"
+    Release:PRE_TARGETDEPS += $$OUT_PWD/../Wrappers/release/libWrappers.a
+    Debug:PRE_TARGETDEPS += $$OUT_PWD/../Wrappers/debug/libWrappers.a
+} else:unix: {
+    PRE_TARGETDEPS += $$OUT_PWD/../Wrappers/libWrappers.a
+}
+
+INCLUDEPATH += $$PWD/../MassEffectModder $$PWD/../Wrappers
+!win32 {
+    INCLUDEPATH += $$PWD/../Libs/omp
+}
+
+DEPENDPATH += $$PWD/../Wrappers
+
+win32-g++: {
+Release:LIBS += \
+    -L$$OUT_PWD/../Wrappers/release -lWrappers \
+    -L$$OUT_PWD/../Libs/7z/release -l7z \
+    -L$$OUT_PWD/../Libs/bfd/release -lbfd \
+    -L$$OUT_PWD/../Libs/dxtc/release -ldxtc \
+    -L$$OUT_PWD/../Libs/lzo2/release -llzo2 \
+    -L$$OUT_PWD/../Libs/png/release -lpng \
+    -L$$OUT_PWD/../Libs/xdelta3/release -lxdelta3 \
+    -L$$OUT_PWD/../Libs/zlib/release -lzlib \
+    -L$$OUT_PWD/../Libs/zstd/release -lzstd \
+    -L$$OUT_PWD/../Libs/unrar/release -lunrar
+Debug:LIBS += \
+    -L$$OUT_PWD/../Wrappers/debug -lWrappers \
+    -L$$OUT_PWD/../Libs/7z/debug -l7z \
+    -L$$OUT_PWD/../Libs/bfd/debug -lbfd \
+    -L$$OUT_PWD/../Libs/dxtc/debug -ldxtc \
+    -L$$OUT_PWD/../Libs/lzo2/debug -llzo2 \
+    -L$$OUT_PWD/../Libs/png/debug -lpng \
+    -L$$OUT_PWD/../Libs/xdelta3/debug -lxdelta3 \
+    -L$$OUT_PWD/../Libs/zlib/debug -lzlib \
+    -L$$OUT_PWD/../Libs/zstd/debug -lzstd \
+    -L$$OUT_PWD/../Libs/unrar/debug -lunrar
+} else:unix: {
+LIBS += \
+    -L$$OUT_PWD/../Wrappers -lWrappers \
+    -L$$OUT_PWD/../Libs/7z -l7z \
+    -L$$OUT_PWD/../Libs/bfd -lbfd \
+    -L$$OUT_PWD/../Libs/dxtc -ldxtc \
+    -L$$OUT_PWD/../Libs/lzo2 -llzo2 \
+    -L$$OUT_PWD/../Libs/omp -lomp \
+    -L$$OUT_PWD/../Libs/png -lpng \
+    -L$$OUT_PWD/../Libs/xdelta3 -lxdelta3 \
+    -L$$OUT_PWD/../Libs/zlib -lzlib \
+    -L$$OUT_PWD/../Libs/zstd -lzstd \
+    -L$$OUT_PWD/../Libs/unrar -lunrar
+}
+
+macx {
+    QMAKE_CXXFLAGS += -Xpreprocessor -fopenmp
+    QMAKE_CXXFLAGS_RELEASE += -fvisibility=hidden -fvisibility-inlines-hidden
+    QMAKE_MACOSX_DEPLOYMENT_TARGET = 10.13
+}
+
+win32 {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -limagehlp -lpsapi -lgomp
+}
+
+linux {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -ldl
+    equals(QMAKE_CXX, clang++) {
+        # backtrace require compile with 'dynamic' flag
+        QMAKE_LFLAGS += -rdynamic
+    }
+}
@@ -18,12 +18,8 @@ SUBDIRS += Libs/omp
 SUBDIRS += \
     Libs/png \
     Libs/xdelta3 \
-    Libs/zlib
-
-equals(ZSTD_ENABLE, true) {
-SUBDIRS += \
+    Libs/zlib \
     Libs/zstd
-}
 
 SUBDIRS += \
     Libs/unrar \
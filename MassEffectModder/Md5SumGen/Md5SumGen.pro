@@ -10,6 +10,7 @@ TARGET = Md5SumGen
 TEMPLATE = app
 
 SOURCES += \
+    ../MassEffectModder/Helpers/BufferPool.cpp \
     ../MassEffectModder/Helpers/FileStream.cpp \
     ../MassEffectModder/Helpers/Logs.cpp \
     ../MassEffectModder/Helpers/MemoryStream.cpp \
@@ -26,6 +27,7 @@ SOURCES += \
 PRECOMPILED_HEADER = ../MassEffectModder/Types/Precompiled.h
 
 HEADERS += \
+    ../MassEffectModder/Helpers/BufferPool.h \
     ../MassEffectModder/Helpers/ByteBuffer.h \
     ../MassEffectModder/Helpers/Exception.h \
     ../MassEffectModder/Helpers/FileStream.h \
@@ -21,10 +21,18 @@
 
 #define PNG_DEBUG 3
 #include <png.h>
+#include <zlib.h>
 #include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
+
+#include "Wrappers.h"
 
 #define PNG_SIGN_LEN 8
+#define PNG_PIXEL_BYTES 4
+#define PNG_BLOCK_SIZE 0x20000 // 128KB of filtered rows per compression block
+#define PNG_DICT_SIZE 0x8000 // deflate window
 
 typedef struct {
     unsigned char *bufferPtr;
@@ -42,24 +50,6 @@ static void ReadFunction(png_structp pngStruct, png_bytep buffer, png_size_t cou
     handle->bufferOffset += count;
 }
 
-static void WriteFunction(png_structp pngStruct, png_bytep buffer, png_size_t count)
-{
-    auto *handle = static_cast<IoHandle *>(png_get_io_ptr(pngStruct));
-    if (!handle->bufferPtr)
-        handle->bufferPtr = static_cast<unsigned char *>(malloc(count));
-    else
-    {
-        png_size_t newPosition = handle->bufferOffset + count;
-        if (newPosition > handle->bufferSize)
-        {
-            handle->bufferSize = newPosition + handle->bufferSize * 2;
-            handle->bufferPtr = static_cast<unsigned char *>(realloc(handle->bufferPtr, handle->bufferSize));
-        }
-    }
-    memcpy(handle->bufferPtr + handle->bufferOffset, buffer, count);
-    handle->bufferOffset += count;
-}
-
 int PngRead(unsigned char *src, unsigned int srcSize,
              unsigned char **dst, unsigned int *dstSize,
              unsigned int *width, unsigned int *height)
@@ -151,58 +141,296 @@ int PngRead(unsigned char *src, unsigned int srcSize,
     return 0;
 }
 
-int PngWrite(const unsigned char *src, unsigned char **dst, unsigned int *dstSize,
-               unsigned int width, unsigned int height)
+static inline int PaethPredictor(int a, int b, int c)
 {
-    IoHandle handle;
-    png_structp pngStruct;
-    png_infop pngInfo;
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+static void FilterRow(int filter, const unsigned char *row, const unsigned char *prev,
+                      unsigned char *out, unsigned int rowBytes)
+{
+    out[0] = static_cast<unsigned char>(filter);
+    out++;
+    switch (filter)
+    {
+    case PNG_WRITE_FILTER_NONE:
+        memcpy(out, row, rowBytes);
+        break;
+    case PNG_WRITE_FILTER_SUB:
+        for (unsigned int i = 0; i < rowBytes; i++)
+            out[i] = row[i] - (i >= PNG_PIXEL_BYTES ? row[i - PNG_PIXEL_BYTES] : 0);
+        break;
+    case PNG_WRITE_FILTER_UP:
+        for (unsigned int i = 0; i < rowBytes; i++)
+            out[i] = row[i] - prev[i];
+        break;
+    case PNG_WRITE_FILTER_AVERAGE:
+        for (unsigned int i = 0; i < rowBytes; i++)
+        {
+            int left = i >= PNG_PIXEL_BYTES ? row[i - PNG_PIXEL_BYTES] : 0;
+            out[i] = row[i] - static_cast<unsigned char>((left + prev[i]) >> 1);
+        }
+        break;
+    case PNG_WRITE_FILTER_PAETH:
+        for (unsigned int i = 0; i < rowBytes; i++)
+        {
+            int left = i >= PNG_PIXEL_BYTES ? row[i - PNG_PIXEL_BYTES] : 0;
+            int upLeft = i >= PNG_PIXEL_BYTES ? prev[i - PNG_PIXEL_BYTES] : 0;
+            out[i] = row[i] - static_cast<unsigned char>(PaethPredictor(left, prev[i], upLeft));
+        }
+        break;
+    }
+}
 
-    handle.bufferOffset = 0;
-    handle.bufferSize = 0;
-    handle.bufferPtr = nullptr;
+static unsigned long FilterRowCost(const unsigned char *out, unsigned int rowBytes)
+{
+    unsigned long sum = 0;
+    for (unsigned int i = 1; i <= rowBytes; i++)
+        sum += static_cast<unsigned long>(abs(static_cast<signed char>(out[i])));
+    return sum;
+}
 
-    pngStruct = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!pngStruct)
-        return -1;
+// Convert BGRA rows to RGBA and filter them, the adaptive mode picks
+// per row the filter with the minimum sum of absolute differences like libpng.
+static void FilterRows(const unsigned char *src, unsigned char *dst, unsigned int width,
+                       unsigned int firstRow, unsigned int lastRow, int filterMode)
+{
+    unsigned int rowBytes = width * PNG_PIXEL_BYTES;
+    std::vector<unsigned char> rows(rowBytes * 2, 0);
+    std::vector<unsigned char> candidate(filterMode == PNG_WRITE_FILTER_ADAPTIVE ? rowBytes + 1 : 0);
+    unsigned char *row = rows.data();
+    unsigned char *prev = rows.data() + rowBytes;
 
-    pngInfo = png_create_info_struct(pngStruct);
-    if (!pngInfo)
+    for (unsigned int y = (firstRow > 0 ? firstRow - 1 : firstRow); y < lastRow; y++)
+    {
+        const unsigned char *srcRow = src + static_cast<size_t>(y) * rowBytes;
+        for (unsigned int x = 0; x < rowBytes; x += PNG_PIXEL_BYTES)
+        {
+            row[x + 0] = srcRow[x + 2];
+            row[x + 1] = srcRow[x + 1];
+            row[x + 2] = srcRow[x + 0];
+            row[x + 3] = srcRow[x + 3];
+        }
+        if (y >= firstRow)
+        {
+            unsigned char *out = dst + static_cast<size_t>(y) * (rowBytes + 1);
+            if (filterMode != PNG_WRITE_FILTER_ADAPTIVE)
+            {
+                FilterRow(filterMode, row, prev, out, rowBytes);
+            }
+            else
+            {
+                FilterRow(PNG_WRITE_FILTER_NONE, row, prev, out, rowBytes);
+                unsigned long bestCost = FilterRowCost(out, rowBytes);
+                for (int f = PNG_WRITE_FILTER_SUB; f <= PNG_WRITE_FILTER_PAETH; f++)
+                {
+                    FilterRow(f, row, prev, candidate.data(), rowBytes);
+                    unsigned long cost = FilterRowCost(candidate.data(), rowBytes);
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        memcpy(out, candidate.data(), rowBytes + 1);
+                    }
+                }
+            }
+        }
+        unsigned char *tmp = prev;
+        prev = row;
+        row = tmp;
+    }
+}
+
+struct PngBlock
+{
+    size_t offset;
+    size_t size;
+    std::vector<unsigned char> data;
+    uLong adler;
+    uLong crc;
+    int status;
+};
+
+// Compress one block as raw deflate data. Blocks other than the last end
+// on a byte boundary with a sync flush, so they can be simply concatenated.
+// The tail of the previous block is used as dictionary to keep the ratio
+// close to the single stream.
+static void CompressBlock(PngBlock &block, const unsigned char *filtered,
+                          int compressionLevel, bool last)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    block.status = deflateInit2(&strm, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (block.status != Z_OK)
+        return;
+
+    if (block.offset > 0)
+    {
+        size_t dictSize = block.offset < PNG_DICT_SIZE ? block.offset : PNG_DICT_SIZE;
+        deflateSetDictionary(&strm, filtered + block.offset - dictSize, static_cast<uInt>(dictSize));
+    }
+
+    block.data.resize(deflateBound(&strm, static_cast<uLong>(block.size)) + 16);
+    strm.next_in = const_cast<Bytef *>(filtered + block.offset);
+    strm.avail_in = static_cast<uInt>(block.size);
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    size_t written = 0;
+    do
+    {
+        if (written == block.data.size())
+            block.data.resize(block.data.size() * 2);
+        strm.next_out = block.data.data() + written;
+        strm.avail_out = static_cast<uInt>(block.data.size() - written);
+        block.status = deflate(&strm, flush);
+        written = block.data.size() - strm.avail_out;
+    } while (block.status == Z_OK && (strm.avail_out == 0 || strm.avail_in != 0 || last));
+    deflateEnd(&strm);
+    if (block.status == Z_BUF_ERROR || block.status == Z_STREAM_END)
+        block.status = Z_OK;
+    block.data.resize(written);
+
+    block.adler = adler32(adler32(0L, Z_NULL, 0), filtered + block.offset, static_cast<uInt>(block.size));
+    block.crc = crc32(0L, block.data.data(), static_cast<uInt>(written));
+}
+
+static unsigned char *WriteUint32BE(unsigned char *dst, uLong value)
+{
+    dst[0] = static_cast<unsigned char>(value >> 24);
+    dst[1] = static_cast<unsigned char>(value >> 16);
+    dst[2] = static_cast<unsigned char>(value >> 8);
+    dst[3] = static_cast<unsigned char>(value);
+    return dst + 4;
+}
+
+static unsigned char *WriteChunk(unsigned char *dst, const char *type,
+                                 const unsigned char *data, unsigned int size)
+{
+    dst = WriteUint32BE(dst, size);
+    memcpy(dst, type, 4);
+    if (size != 0)
+        memcpy(dst + 4, data, size);
+    uLong crc = crc32(0L, dst, size + 4);
+    return WriteUint32BE(dst + 4 + size, crc);
+}
+
+int PngWrite(const unsigned char *src, unsigned char **dst, unsigned int *dstSize,
+             unsigned int width, unsigned int height, int compressionLevel,
+             int filterMode, int numThreads)
+{
+    if (width == 0 || height == 0 ||
+        compressionLevel < Z_DEFAULT_COMPRESSION || compressionLevel > Z_BEST_COMPRESSION ||
+        filterMode < PNG_WRITE_FILTER_ADAPTIVE || filterMode > PNG_WRITE_FILTER_PAETH)
     {
-        png_destroy_write_struct(&pngStruct, &pngInfo);
         return -1;
     }
+    if (numThreads < 1)
+        numThreads = 1;
 
-    png_set_IHDR(pngStruct, pngInfo, width, height,
-                 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    size_t filteredRowBytes = static_cast<size_t>(width) * PNG_PIXEL_BYTES + 1;
+    size_t filteredSize = filteredRowBytes * height;
+    if (filteredSize > 0x7FFFFFFF)
+        return -1;
+    std::vector<unsigned char> filtered(filteredSize);
 
-    png_set_write_fn(pngStruct, &handle, WriteFunction, nullptr);
+    // Split rows into blocks, each filtered and compressed independently.
+    unsigned int rowsPerBlock = height;
+    if (numThreads > 1)
+    {
+        rowsPerBlock = static_cast<unsigned int>(PNG_BLOCK_SIZE / filteredRowBytes);
+        if (rowsPerBlock == 0)
+            rowsPerBlock = 1;
+    }
+    int numBlocks = static_cast<int>((height + rowsPerBlock - 1) / rowsPerBlock);
+    std::vector<PngBlock> blocks(numBlocks);
+    for (int b = 0; b < numBlocks; b++)
+    {
+        blocks[b].offset = static_cast<size_t>(b) * rowsPerBlock * filteredRowBytes;
+        unsigned int lastRow = (b + 1) * rowsPerBlock;
+        if (lastRow > height)
+            lastRow = height;
+        blocks[b].size = (lastRow - b * rowsPerBlock) * filteredRowBytes;
+    }
 
-    png_write_info(pngStruct, pngInfo);
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (int b = 0; b < numBlocks; b++)
+    {
+        unsigned int lastRow = (b + 1) * rowsPerBlock;
+        FilterRows(src, filtered.data(), width, b * rowsPerBlock,
+                   lastRow > height ? height : lastRow, filterMode);
+    }
 
-    unsigned char lineData[width * 4];
-    int srcOffset = 0;
-    for (png_uint_32 y = 0; y < height; y++)
+    // Compression of a block needs the tail of the previous block as dictionary,
+    // so it starts only after all rows are filtered.
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int b = 0; b < numBlocks; b++)
     {
-        int lineOffset = 0;
-        for (png_uint_32 x = 0; x < width; x++)
-        {
-            lineData[lineOffset++] = src[srcOffset + 2];
-            lineData[lineOffset++] = src[srcOffset + 1];
-            lineData[lineOffset++] = src[srcOffset + 0];
-            lineData[lineOffset++] = src[srcOffset + 3];
-            srcOffset += 4;
-        }
-        png_write_row(pngStruct, (png_bytep)lineData);
+        CompressBlock(blocks[b], filtered.data(), compressionLevel, b == numBlocks - 1);
     }
 
-    png_write_end(pngStruct, nullptr);
+    // zlib header, FLEVEL only informs the decoder about used level.
+    int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : compressionLevel;
+    int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned char zlibHeader[2] = { 0x78, static_cast<unsigned char>(flevel << 6) };
+    zlibHeader[1] += 31 - ((zlibHeader[0] << 8) + zlibHeader[1]) % 31;
 
-    png_destroy_write_struct(&pngStruct, &pngInfo);
+    uLong idatCrc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>("IDAT"), 4);
+    idatCrc = crc32(idatCrc, zlibHeader, 2);
+    uLong adler = adler32(0L, Z_NULL, 0);
+    size_t idatSize = 2 + 4;
+    for (int b = 0; b < numBlocks; b++)
+    {
+        if (blocks[b].status != Z_OK)
+            return -1;
+        idatCrc = crc32_combine(idatCrc, blocks[b].crc, static_cast<z_off_t>(blocks[b].data.size()));
+        adler = adler32_combine(adler, blocks[b].adler, static_cast<z_off_t>(blocks[b].size));
+        idatSize += blocks[b].data.size();
+    }
+    if (idatSize > 0x7FFFFFFF)
+        return -1;
+    unsigned char zlibTrailer[4];
+    WriteUint32BE(zlibTrailer, adler);
+    idatCrc = crc32(idatCrc, zlibTrailer, 4);
+
+    unsigned char ihdr[13];
+    WriteUint32BE(ihdr, width);
+    WriteUint32BE(ihdr + 4, height);
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = PNG_COLOR_TYPE_RGB_ALPHA;
+    ihdr[10] = PNG_COMPRESSION_TYPE_BASE;
+    ihdr[11] = PNG_FILTER_TYPE_BASE;
+    ihdr[12] = PNG_INTERLACE_NONE;
+
+    size_t totalSize = PNG_SIGN_LEN + (12 + sizeof(ihdr)) + (12 + idatSize) + 12;
+    auto *ptr = static_cast<unsigned char *>(malloc(totalSize));
+    if (ptr == nullptr)
+        return -1;
+    *dst = ptr;
+    *dstSize = static_cast<unsigned int>(totalSize);
+
+    static const unsigned char signature[PNG_SIGN_LEN] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    memcpy(ptr, signature, PNG_SIGN_LEN);
+    ptr = WriteChunk(ptr + PNG_SIGN_LEN, "IHDR", ihdr, sizeof(ihdr));
+
+    ptr = WriteUint32BE(ptr, static_cast<uLong>(idatSize));
+    memcpy(ptr, "IDAT", 4);
+    memcpy(ptr + 4, zlibHeader, 2);
+    ptr += 6;
+    for (int b = 0; b < numBlocks; b++)
+    {
+        memcpy(ptr, blocks[b].data.data(), blocks[b].data.size());
+        ptr += blocks[b].data.size();
+    }
+    memcpy(ptr, zlibTrailer, 4);
+    ptr = WriteUint32BE(ptr + 4, idatCrc);
 
-    *dst = handle.bufferPtr;
-    *dstSize = handle.bufferOffset;
+    WriteChunk(ptr, "IEND", nullptr, 0);
 
     return 0;
 }
@@ -46,34 +46,44 @@ int ZlibDecompress(unsigned char *src, unsigned int src_len, unsigned char *dst,
     return status;
 }
 
-int ZlibCompress(unsigned char *src, unsigned int src_len,
-                 unsigned char **dst, unsigned int *dst_len, int compression_level)
+unsigned int ZlibCompressBound(unsigned int src_len)
 {
-    int tmpBufLen = (src_len * 2) + 128;
-    uLongf len = tmpBufLen;
-    auto *tmpbuf = new unsigned char[tmpBufLen];
-    if (tmpbuf == nullptr)
-        return -100;
+    return static_cast<unsigned int>(compressBound(static_cast<uLong>(src_len)));
+}
+
+int ZlibCompressToBuffer(unsigned char *src, unsigned int src_len,
+                         unsigned char *dst, unsigned int *dst_len, int compression_level)
+{
+    uLongf len = *dst_len;
 
-    int status = compress2(static_cast<Bytef *>(tmpbuf), &len, static_cast<Bytef *>(src), static_cast<uLong>(src_len), compression_level);
+    int status = compress2(static_cast<Bytef *>(dst), &len, static_cast<Bytef *>(src), static_cast<uLong>(src_len), compression_level);
     if (status == Z_OK)
-    {
-        *dst = new unsigned char[len];
-        if (*dst == nullptr)
-        {
-            delete[] tmpbuf;
-            return -100;
-        }
-        memcpy(*dst, tmpbuf, len);
         *dst_len = static_cast<unsigned int>(len);
-    }
     else
     {
         printf("compress2 failed - error: %d\n", status);
         *dst_len = 0;
     }
 
-    delete[] tmpbuf;
+    return status;
+}
+
+int ZlibCompress(unsigned char *src, unsigned int src_len,
+                 unsigned char **dst, unsigned int *dst_len, int compression_level)
+{
+    // compress straight to the result buffer sized by the bound, no extra copy
+    unsigned int len = ZlibCompressBound(src_len);
+    *dst = new unsigned char[len];
+    if (*dst == nullptr)
+        return -100;
+
+    int status = ZlibCompressToBuffer(src, src_len, *dst, &len, compression_level);
+    if (status != Z_OK)
+    {
+        delete[] *dst;
+        *dst = nullptr;
+    }
+    *dst_len = len;
 
     return status;
 }
@@ -22,6 +22,7 @@
 #define ZSTD_STATIC_LINKING_ONLY
 #include <zstd.h>
 #include <cstring>
+#include <cstdio>
 #include <memory>
 
 int ZstdDecompress(unsigned char *src, unsigned int src_len, unsigned char *dst, unsigned int *dst_len)
@@ -55,33 +56,50 @@ int ZstdDecompress(unsigned char *src, unsigned int src_len, unsigned char *dst,
     return 0;
 }
 
-int ZstdCompress(unsigned char *src, unsigned int src_len,
-                 unsigned char **dst, unsigned int *dst_len, int compression_level)
+unsigned int ZstdCompressBound(unsigned int src_len)
 {
-    size_t const tmpBufLen = ZSTD_compressBound(src_len);
-    auto *tmpbuf = new unsigned char[tmpBufLen];
-    if (tmpbuf == nullptr)
-        return -100;
+    return static_cast<unsigned int>(ZSTD_COMPRESSBOUND(src_len));
+}
 
-    size_t const cSize = ZSTD_compress(tmpbuf, tmpBufLen, src, src_len, compression_level);
+int ZstdCompressToBuffer(unsigned char *src, unsigned int src_len,
+                         unsigned char *dst, unsigned int *dst_len, int compression_level)
+{
+#if !defined(ZSTD_ENABLE)
+    // compressor is not built in
+    *dst_len = 0;
+    printf("zstd compress failed - Error: not supported\n");
+    return -1;
+#else
+    size_t const cSize = ZSTD_compress(dst, *dst_len, src, src_len, compression_level);
     if (ZSTD_isError(cSize))
     {
         *dst_len = 0;
         printf("zstd compress failed - Error: %s\n", ZSTD_getErrorName(cSize));
-    }
-    else
-    {
-        *dst = new unsigned char[cSize];
-        if (*dst == nullptr)
-        {
-            delete[] tmpbuf;
-            return -100;
-        }
-        memcpy(*dst, tmpbuf, cSize);
-        *dst_len = static_cast<unsigned int>(cSize);
+        return -1;
     }
 
-    delete[] tmpbuf;
+    *dst_len = static_cast<unsigned int>(cSize);
 
     return 0;
+#endif
+}
+
+int ZstdCompress(unsigned char *src, unsigned int src_len,
+                 unsigned char **dst, unsigned int *dst_len, int compression_level)
+{
+    // compress straight to the result buffer sized by the bound, no extra copy
+    unsigned int len = ZstdCompressBound(src_len);
+    *dst = new unsigned char[len];
+    if (*dst == nullptr)
+        return -100;
+
+    int status = ZstdCompressToBuffer(src, src_len, *dst, &len, compression_level);
+    if (len == 0)
+    {
+        delete[] *dst;
+        *dst = nullptr;
+    }
+    *dst_len = len;
+
+    return status;
 }
@@ -53,15 +53,28 @@ int XDelta3Decompress(BYTE *src, UINT32 src_len, BYTE *delta, UINT32 delta_len,
 
 int ZlibDecompress(BYTE *src, UINT32 src_len, BYTE *dst, UINT32 *dst_len);
 int ZlibCompress(BYTE *src, UINT32 src_len, BYTE **dst, UINT32 *dst_len, int compression_level = -1);
+int ZlibCompressToBuffer(BYTE *src, UINT32 src_len, BYTE *dst, UINT32 *dst_len, int compression_level = -1);
+UINT32 ZlibCompressBound(UINT32 src_len);
 
 int ZstdDecompress(BYTE *src, UINT32 src_len, BYTE *dst, UINT32 *dst_len);
 int ZstdCompress(BYTE *src, UINT32 src_len, BYTE **dst, UINT32 *dst_len, int compression_level = 3);
+int ZstdCompressToBuffer(BYTE *src, UINT32 src_len, BYTE *dst, UINT32 *dst_len, int compression_level = 3);
+UINT32 ZstdCompressBound(UINT32 src_len);
 
 int PngRead(BYTE *src, UINT32 srcSize,
              BYTE **dst, UINT32 *dstSize,
              UINT32 *width, UINT32 *height);
+
+#define PNG_WRITE_FILTER_ADAPTIVE -1
+#define PNG_WRITE_FILTER_NONE     0
+#define PNG_WRITE_FILTER_SUB      1
+#define PNG_WRITE_FILTER_UP       2
+#define PNG_WRITE_FILTER_AVERAGE  3
+#define PNG_WRITE_FILTER_PAETH    4
+
 int PngWrite(const BYTE *src, BYTE **dst, UINT32 *dstSize,
-              UINT32 width, UINT32 height);
+              UINT32 width, UINT32 height, int compressionLevel = -1,
+              int filterMode = PNG_WRITE_FILTER_ADAPTIVE, int numThreads = 1);
 
 #define BLOCK_SIZE_4X4        16
 #define BLOCK_SIZE_4X4X4      64
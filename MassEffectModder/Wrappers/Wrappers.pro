@@ -11,23 +11,22 @@ SOURCES += \
     WrapperUnzip.cpp \
     WrapperUnrar.cpp \
     WrapperXdelta.cpp \
-    WrapperZlib.cpp
-
-equals(ZSTD_ENABLE, true) {
-SOURCES += \
+    WrapperZlib.cpp \
     WrapperZstd.cpp
-}
 
 macx {
     SOURCES += BacktraceMac.cpp
+    QMAKE_CXXFLAGS += -Xpreprocessor -fopenmp
 }
 
 win32 {
     SOURCES += BacktraceWin.cpp
+    QMAKE_CXXFLAGS += -fopenmp
 }
 
 linux {
     SOURCES += BacktraceLin.cpp
+    QMAKE_CXXFLAGS += -fopenmp
 }
 
 HEADERS += Wrappers.h
@@ -39,6 +38,10 @@ QMAKE_CXXFLAGS_DEBUG += -g
 
 DEFINES +=
 
+equals(ZSTD_ENABLE, true) {
+    DEFINES += ZSTD_ENABLE
+}
+
 INCLUDEPATH += \
     $$PWD/../Libs/7z \
     $$PWD/../Libs/bfd \